@@ -0,0 +1,344 @@
+// In-process microbenchmarks for the server core: no sockets, no threads
+// other than the engine's own housekeeping. Built by `make microbench` against
+// libredis_core.a.
+#include "redis_core.h"
+
+#include <iomanip>
+
+class Microbenchmark {
+private:
+    RedisClone engine;
+    size_t sink = 0;
+    
+    template <typename Fn>
+    void run(const std::string& name, uint64_t iterations, Fn&& fn) {
+        for (uint64_t i = 0; i < iterations / 10 + 1; ++i) {
+            fn(i);
+        }
+        
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iterations; ++i) {
+            fn(i);
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        
+        print_row(name, iterations, std::chrono::duration<double, std::nano>(elapsed).count() / iterations);
+    }
+    
+    static void print_row(const std::string& name, uint64_t iterations, double ns) {
+        std::cout << std::left << std::setw(40) << name << std::right << std::setw(12) << iterations
+                  << std::fixed << std::setprecision(1) << std::setw(12) << ns
+                  << std::setw(14) << static_cast<long long>(1e9 / ns) << std::endl;
+    }
+    
+    std::string exec(const std::vector<std::string>& tokens) {
+        return engine.execute(tokens);
+    }
+
+public:
+    void run_encoding() {
+        std::string small(16, 'x'), large(1024, 'x');
+        std::vector<std::string> elements(10, small);
+        
+        run("encode_bulk_string 16B", 2000000, [&](uint64_t) { sink += encode_bulk_string(small).size(); });
+        run("encode_bulk_string 1KB", 1000000, [&](uint64_t) { sink += encode_bulk_string(large).size(); });
+        run("encode_integer", 2000000, [&](uint64_t i) { sink += encode_integer(i * 7919).size(); });
+        run("encode_array 10x16B", 500000, [&](uint64_t) { sink += encode_array(elements).size(); });
+        
+        // The append forms write into a buffer that keeps its capacity, as the
+        // per-connection reply buffer does.
+        std::string buffer;
+        run("append_bulk_string 16B", 2000000, [&](uint64_t) {
+            buffer.clear();
+            append_bulk_string(buffer, small);
+            sink += buffer.size();
+        });
+        run("append_bulk_string 1KB", 1000000, [&](uint64_t) {
+            buffer.clear();
+            append_bulk_string(buffer, large);
+            sink += buffer.size();
+        });
+        run("append_integer", 2000000, [&](uint64_t i) {
+            buffer.clear();
+            append_integer(buffer, i * 7919);
+            sink += buffer.size();
+        });
+        run("append array 10x16B (streamed)", 500000, [&](uint64_t) {
+            buffer.clear();
+            append_array_header(buffer, elements.size());
+            for (const auto& element : elements) {
+                append_bulk_string(buffer, element);
+            }
+            sink += buffer.size();
+        });
+    }
+    
+    void run_parsing() {
+        std::string inline_line = "SET user:1000 some_value_of_moderate_size";
+        run("parse_command inline SET", 1000000, [&](uint64_t) {
+            sink += parse_command(inline_line).size();
+        });
+        
+        const int kPipeline = 100;
+        std::string pipeline;
+        for (int i = 0; i < kPipeline; ++i) {
+            pipeline += "*3\r\n$3\r\nSET\r\n$9\r\nuser:" + std::to_string(1000 + i) + "\r\n$16\r\nvalue_0123456789\r\n";
+        }
+        std::vector<std::string> tokens;
+        run("parse_request 100 pipelined RESP SETs", 20000, [&](uint64_t) {
+            size_t pos = 0;
+            while (parse_request(pipeline, pos, tokens) == REQUEST_READY) {
+                sink += tokens.size();
+            }
+        });
+    }
+    
+    void run_commands() {
+        const uint64_t kKeys = 1000;
+        std::vector<std::string> keys;
+        for (uint64_t i = 0; i < kKeys; ++i) {
+            keys.push_back("key:" + std::to_string(i));
+        }
+        std::string value(64, 'v');
+        
+        run("SET", 500000, [&](uint64_t i) { sink += exec({"SET", keys[i % kKeys], value}).size(); });
+        run("GET hit", 500000, [&](uint64_t i) { sink += exec({"GET", keys[i % kKeys]}).size(); });
+        run("GET miss", 500000, [&](uint64_t i) { sink += exec({"GET", "missing:" + keys[i % kKeys]}).size(); });
+        run("EXISTS", 500000, [&](uint64_t i) { sink += exec({"EXISTS", keys[i % kKeys]}).size(); });
+        run("LPUSH + LPOP", 250000, [&](uint64_t i) {
+            sink += exec({"LPUSH", "list", keys[i % kKeys]}).size();
+            sink += exec({"LPOP", "list"}).size();
+        });
+        run("HSET", 500000, [&](uint64_t i) { sink += exec({"HSET", "hash", keys[i % 16], value}).size(); });
+        run("HGET", 500000, [&](uint64_t i) { sink += exec({"HGET", "hash", keys[i % 16]}).size(); });
+        run("HGETALL 16 fields", 100000, [&](uint64_t) { sink += exec({"HGETALL", "hash"}).size(); });
+        run("SADD", 500000, [&](uint64_t i) { sink += exec({"SADD", "set", keys[i % 16]}).size(); });
+        run("SMEMBERS 16 members", 100000, [&](uint64_t) { sink += exec({"SMEMBERS", "set"}).size(); });
+        for (int i = 0; i < 100; ++i) exec({"RPUSH", "range", value});
+        run("LRANGE 0 9", 100000, [&](uint64_t) { sink += exec({"LRANGE", "range", "0", "9"}).size(); });
+        exec({"FLUSHALL"});
+    }
+    
+    // A reader on a key another thread keeps overwriting. GET goes through
+    // the read index and never takes data_mutex, so its rows show the cost of
+    // reading while entries are being replaced and reclaimed, not lock waits.
+    // HGET under HSET still takes the shared lock against the writer's
+    // exclusive one, for contrast. Reports the mean and the tail.
+    void run_contention() {
+        const uint64_t kIterations = 200000;
+        std::vector<double> latencies(kIterations);
+        struct Case {
+            std::string name;
+            std::vector<std::string> read, write;
+            std::string writer_name;
+        };
+        std::vector<Case> cases;
+        for (size_t size : {64, 4096, 65536}) {
+            std::string value(size, 'v');
+            cases.push_back({"GET " + std::to_string(size) + "B under SET load", {"GET", "contended"},
+                             {"SET", "contended", value}, "  concurrent SET " + std::to_string(size) + "B"});
+        }
+        cases.push_back({"HGET 64B under HSET load (locked)", {"HGET", "contended_hash", "field"},
+                         {"HSET", "contended_hash", "field", std::string(64, 'v')}, "  concurrent HSET 64B"});
+        
+        for (const Case& c : cases) {
+            exec(c.write);
+            
+            std::atomic<bool> stop{false};
+            std::atomic<uint64_t> writes{0};
+            std::thread writer([&]() {
+                while (!stop.load(std::memory_order_relaxed)) {
+                    engine.execute(c.write);
+                    writes.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+            
+            double total_ns = 0;
+            for (uint64_t i = 0; i < kIterations; ++i) {
+                auto start = std::chrono::steady_clock::now();
+                sink += exec(c.read).size();
+                latencies[i] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+                total_ns += latencies[i];
+            }
+            stop = true;
+            writer.join();
+            
+            std::sort(latencies.begin(), latencies.end());
+            print_row(c.name, kIterations, total_ns / kIterations);
+            print_row(c.name + " p99", kIterations, latencies[kIterations * 99 / 100]);
+            print_row(c.writer_name, writes.load(), total_ns / writes.load());
+        }
+        exec({"FLUSHALL"});
+    }
+    
+    // Aggregate read throughput as reader threads are added. get() takes the
+    // epoch read path; llen() still takes the shared lock, for contrast.
+    // Rows report wall time per operation across all threads.
+    void run_read_scaling() {
+        const uint64_t kKeys = 1000, kOpsPerThread = 200000;
+        std::vector<std::string> keys, lists;
+        for (uint64_t i = 0; i < kKeys; ++i) {
+            keys.push_back("key:" + std::to_string(i));
+            lists.push_back("list:" + std::to_string(i));
+            engine.set(keys.back(), std::string(64, 'v'));
+            engine.rpush(lists.back(), "v");
+        }
+        
+        for (bool locked : {false, true}) {
+            for (unsigned threads : {1u, 2u, 4u, 8u, 16u, 32u, 64u}) {
+                std::atomic<size_t> total{0};
+                auto start = std::chrono::steady_clock::now();
+                std::vector<std::thread> readers;
+                for (unsigned t = 0; t < threads; ++t) {
+                    readers.emplace_back([&, t]() {
+                        std::string value;
+                        size_t local = 0;
+                        for (uint64_t i = 0; i < kOpsPerThread; ++i) {
+                            size_t key = (i * 7919 + t) % kKeys;
+                            local += locked ? engine.llen(lists[key]) : engine.get(keys[key], value);
+                        }
+                        total += local;
+                    });
+                }
+                for (auto& reader : readers) {
+                    reader.join();
+                }
+                double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+                sink += total;
+                print_row(std::string(locked ? "llen" : "get") + " x " + std::to_string(threads) + " threads", kOpsPerThread * threads,
+                          ns / (kOpsPerThread * threads));
+            }
+        }
+        
+        // What the lock-free reads cost writers: every SET or EXPIRE allocates a
+        // new index entry, with its own copy of the key, and retires the old
+        // one. The standalone row is that publish on its own, i.e. roughly
+        // the difference from a SET without the index.
+        std::string value(64, 'v');
+        run("SET (publishes an index entry)", 500000, [&](uint64_t i) { sink += exec({"SET", keys[i % kKeys], value}).size(); });
+        run("EXPIRE (republishes the entry)", 500000, [&](uint64_t i) { sink += exec({"EXPIRE", keys[i % kKeys], "3600"}).size(); });
+        {
+            EpochDomain domain;
+            ReadIndex index(domain);
+            run("ReadIndex publish alone", 500000, [&](uint64_t i) {
+                auto* entry = new ReadIndex::Entry();
+                entry->key = keys[i % kKeys];
+                index.publish(entry);
+            });
+        }
+        std::cout << "  index memory per key: " << sizeof(ReadIndex::Entry) + sizeof(void*)
+                  << " bytes + a heap copy of keys over 15 bytes" << std::endl;
+        exec({"FLUSHALL"});
+    }
+    
+    // Time spent in the command itself, i.e. holding data_mutex, to drop a
+    // large list or hash. UNLINK leaves the destruction to the lazy free thread.
+    void run_lazyfree() {
+        const int kElements = 100000, kRounds = 10;
+        for (bool hash : {false, true}) {
+            for (const char* command : {"DEL", "UNLINK"}) {
+                double total_ns = 0;
+                for (int round = 0; round < kRounds; ++round) {
+                    for (int i = 0; i < kElements; ++i) {
+                        if (hash) {
+                            engine.hset("bighash", "field:" + std::to_string(i), "value");
+                        } else {
+                            engine.rpush("biglist", "element");
+                        }
+                    }
+                    auto start = std::chrono::steady_clock::now();
+                    sink += exec({command, hash ? "bighash" : "biglist"}).size();
+                    total_ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+                }
+                print_row(std::string(command) + (hash ? " 100k-field hash" : " 100k-element list"), kRounds, total_ns / kRounds);
+            }
+        }
+        exec({"FLUSHALL"});
+    }
+    
+    // The keyspace's own map type, driven directly so the numbers exclude
+    // locking and command dispatch.
+    void run_dictionary() {
+        for (uint64_t size : {1000ULL, 1000000ULL}) {
+            std::unordered_map<std::string, std::shared_ptr<RedisValue>> dict;
+            std::vector<std::string> keys;
+            keys.reserve(size);
+            for (uint64_t i = 0; i < size; ++i) {
+                keys.push_back("key:" + std::to_string(i));
+                dict[keys.back()] = std::make_shared<RedisValue>(RedisValue::STRING);
+            }
+            
+            // Stride through the keys so large tables miss in cache as they would in production.
+            run("dict find (" + std::to_string(size) + " keys)", 1000000, [&](uint64_t i) {
+                sink += dict.count(keys[(i * 2654435761ULL) % size]);
+            });
+        }
+    }
+    
+    void run_expiry() {
+        const uint64_t kKeys = 100000;
+        std::string value(16, 'v');
+        
+        // Half the keys carry a TTL; every tenth key is already due.
+        auto populate = [&]() {
+            exec({"FLUSHALL"});
+            for (uint64_t i = 0; i < kKeys; ++i) {
+                std::string key = "key:" + std::to_string(i);
+                exec({"SET", key, value});
+                if (i % 10 == 0) {
+                    exec({"EXPIRE", key, "0"});
+                } else if (i % 2 == 0) {
+                    exec({"EXPIRE", key, "3600"});
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        };
+        
+        populate();
+        engine.expire_sweep();
+        run("expire sweep 100k keys, nothing due", 20, [&](uint64_t) { sink += engine.expire_sweep(); });
+        
+        double total_ns = 0;
+        const int kRounds = 10;
+        for (int round = 0; round < kRounds; ++round) {
+            populate();
+            auto start = std::chrono::steady_clock::now();
+            sink += engine.expire_sweep();
+            total_ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        }
+        print_row("expire sweep 100k keys, 10% due", kRounds, total_ns / kRounds);
+        exec({"FLUSHALL"});
+    }
+    
+    void run_all() {
+        std::cout << "Redis Clone Microbenchmarks" << std::endl;
+        std::cout << "===========================" << std::endl;
+        std::cout << std::left << std::setw(40) << "benchmark" << std::right << std::setw(12) << "iterations"
+                  << std::setw(12) << "ns/op" << std::setw(14) << "ops/sec" << std::endl;
+        
+        std::cout << "\n--- Reply encoding ---" << std::endl;
+        run_encoding();
+        std::cout << "\n--- Request parsing ---" << std::endl;
+        run_parsing();
+        std::cout << "\n--- Commands (in-process, includes locking and stats) ---" << std::endl;
+        run_commands();
+        std::cout << "\n--- Read/write contention ---" << std::endl;
+        run_contention();
+        std::cout << "\n--- Read scaling (" << std::thread::hardware_concurrency() << " hardware threads) ---" << std::endl;
+        run_read_scaling();
+        std::cout << "\n--- Lazy free ---" << std::endl;
+        run_lazyfree();
+        std::cout << "\n--- Keyspace dictionary ---" << std::endl;
+        run_dictionary();
+        std::cout << "\n--- Expiry ---" << std::endl;
+        run_expiry();
+        
+        std::cout << "\n(checksum " << sink << ")" << std::endl;
+    }
+};
+
+int main() {
+    Microbenchmark bench;
+    bench.run_all();
+    return 0;
+}
@@ -8,15 +8,149 @@
 #include <numeric>
 #include <algorithm>
 #include <iomanip>
+#include <cstdlib>
+#include <cstdint>
+#include <cmath>
+#include <deque>
+#include <queue>
+#include <functional>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <iterator>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <fcntl.h>
+#include <cerrno>
 #include <unistd.h>
 
+#include "redis_core.h"
+
+// Returns the offset just past the reply starting at pos, or npos if the
+// buffer does not hold a complete reply yet.
+size_t parse_reply(const std::string& buffer, size_t pos, bool& is_error) {
+    if (pos >= buffer.size()) return std::string::npos;
+    size_t line_end = buffer.find("\r\n", pos);
+    if (line_end == std::string::npos) return std::string::npos;
+    
+    char type = buffer[pos];
+    is_error = type == '-';
+    if (type == '+' || type == '-' || type == ':') return line_end + 2;
+    
+    long long length = std::atoll(buffer.c_str() + pos + 1);
+    if (type == '$') {
+        if (length < 0) return line_end + 2;
+        size_t end = line_end + 2 + length + 2;
+        return end <= buffer.size() ? end : std::string::npos;
+    }
+    if (type == '*') {
+        size_t next = line_end + 2;
+        for (long long i = 0; i < length && next != std::string::npos; ++i) {
+            bool element_error;
+            next = parse_reply(buffer, next, element_error);
+        }
+        return next;
+    }
+    return line_end + 2;
+}
+
+// HDR-style histogram: exact below 2^kSubBucketBits, then kSubBucketBits of
+// precision per power of two (three significant digits). Not thread-safe; each
+// worker records into its own copy and the copies are merged afterwards.
+class HdrHistogram {
+private:
+    static constexpr int kSubBucketBits = 11;
+    static constexpr uint64_t kSubBucketCount = 1ULL << kSubBucketBits;
+    static constexpr uint64_t kHalfCount = kSubBucketCount / 2;
+    static constexpr int kMaxValueBits = 44;
+    static constexpr size_t kBucketCount = (kMaxValueBits - kSubBucketBits + 2) * kHalfCount;
+    
+    std::vector<uint64_t> counts;
+    uint64_t total = 0;
+    uint64_t max_value = 0;
+    
+    static size_t index_of(uint64_t value) {
+        if (value < kSubBucketCount) return value;
+        int msb = 63 - __builtin_clzll(value);
+        int shift = msb - kSubBucketBits + 1;
+        return (shift + 1) * kHalfCount + ((value >> shift) - kHalfCount);
+    }
+    
+    static uint64_t highest_equivalent(size_t index) {
+        if (index < kSubBucketCount) return index;
+        int shift = static_cast<int>(index / kHalfCount) - 1;
+        uint64_t sub = index % kHalfCount + kHalfCount;
+        return ((sub + 1) << shift) - 1;
+    }
+
+public:
+    HdrHistogram() : counts(kBucketCount, 0) {}
+    
+    void record(uint64_t value) {
+        size_t index = std::min(index_of(value), kBucketCount - 1);
+        counts[index]++;
+        total++;
+        max_value = std::max(max_value, value);
+    }
+    
+    void merge(const HdrHistogram& other) {
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            counts[i] += other.counts[i];
+        }
+        total += other.total;
+        max_value = std::max(max_value, other.max_value);
+    }
+    
+    uint64_t count() const {
+        return total;
+    }
+    
+    uint64_t max() const {
+        return max_value;
+    }
+    
+    uint64_t percentile(double pct) const {
+        if (total == 0) return 0;
+        uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(pct / 100.0 * total)));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            seen += counts[i];
+            if (seen >= rank) return std::min(highest_equivalent(i), max_value);
+        }
+        return max_value;
+    }
+};
+
+// Appends a space-separated command to out as a RESP array.
+void append_resp_command(std::string& out, const std::string& command) {
+    std::vector<std::pair<size_t, size_t>> args;
+    size_t start = 0;
+    while (start < command.size()) {
+        size_t end = command.find(' ', start);
+        if (end == std::string::npos) end = command.size();
+        if (end > start) args.emplace_back(start, end - start);
+        start = end + 1;
+    }
+    
+    out += "*" + std::to_string(args.size()) + "\r\n";
+    for (const auto& arg : args) {
+        out += "$" + std::to_string(arg.second) + "\r\n";
+        out.append(command, arg.first, arg.second);
+        out += "\r\n";
+    }
+}
+
 class BenchmarkClient {
 private:
     int sock_fd;
-    
+    std::string out_buffer;
+    std::string in_buffer;
+    size_t pending_replies = 0;
+
 public:
     BenchmarkClient() : sock_fd(-1) {}
     
@@ -35,48 +169,1056 @@ public:
         server_addr.sin_port = htons(port);
         inet_pton(AF_INET, host.c_str(), &server_addr.sin_addr);
         
-        return connect(sock_fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) >= 0;
+        if (connect(sock_fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) return false;
+        
+        int nodelay = 1;
+        setsockopt(sock_fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+        return true;
+    }
+    
+    void queue_command(const std::string& command) {
+        append_resp_command(out_buffer, command);
+        pending_replies++;
+    }
+    
+    size_t pending() const {
+        return pending_replies;
+    }
+    
+    // Sends the queued batch and reads one reply per command. Returns the number
+    // of non-error replies, or -1 if the connection failed.
+    int flush(std::string* last_reply = nullptr) {
+        if (sock_fd < 0) return -1;
+        
+        size_t offset = 0;
+        while (offset < out_buffer.size()) {
+            ssize_t sent = send(sock_fd, out_buffer.data() + offset, out_buffer.size() - offset, MSG_NOSIGNAL);
+            if (sent <= 0) return -1;
+            offset += sent;
+        }
+        out_buffer.clear();
+        
+        int ok = 0;
+        size_t consumed = 0;
+        char buffer[16384];
+        while (pending_replies > 0) {
+            bool is_error = false;
+            size_t end = parse_reply(in_buffer, consumed, is_error);
+            if (end != std::string::npos) {
+                if (last_reply && pending_replies == 1) {
+                    last_reply->assign(in_buffer, consumed, end - consumed);
+                }
+                ok += is_error ? 0 : 1;
+                consumed = end;
+                pending_replies--;
+                continue;
+            }
+            
+            ssize_t received = recv(sock_fd, buffer, sizeof(buffer), 0);
+            if (received <= 0) {
+                pending_replies = 0;
+                return -1;
+            }
+            in_buffer.append(buffer, received);
+        }
+        in_buffer.erase(0, consumed);
+        return ok;
     }
     
     bool send_command_fast(const std::string& command) {
-        if (sock_fd < 0) return false;
+        queue_command(command);
+        return flush() == 1;
+    }
+    
+    std::string query(const std::string& command) {
+        std::string reply;
+        queue_command(command);
+        flush(&reply);
+        return reply;
+    }
+};
+
+// xorshift64* seeded through splitmix64: a few cycles per draw, and a valid
+// UniformRandomBitGenerator for the <random> distributions. One per thread.
+class FastRandom {
+private:
+    uint64_t state;
+
+public:
+    using result_type = uint64_t;
+    
+    explicit FastRandom(uint64_t seed) {
+        uint64_t z = seed + 0x9e3779b97f4a7c15ULL;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        state = (z ^ (z >> 31)) | 1;
+    }
+    
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT64_MAX; }
+    
+    result_type operator()() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545f4914f6cdd1dULL;
+    }
+    
+    // Uniform in [0, bound) via multiply-shift; the bias is below 2^-32 for
+    // any bound we use.
+    uint64_t below(uint64_t bound) {
+        return static_cast<uint64_t>((static_cast<unsigned __int128>((*this)()) * bound) >> 64);
+    }
+    
+    uint64_t between(uint64_t low, uint64_t high) {
+        return low + below(high - low + 1);
+    }
+    
+    double uniform() {
+        return ((*this)() >> 11) * (1.0 / 9007199254740992.0);
+    }
+};
+
+// Read-only block of random alphanumeric bytes built once at startup. Values
+// are copied out of it at random offsets, so generating a value costs a
+// memcpy instead of one RNG draw per byte.
+class ValuePool {
+private:
+    static constexpr size_t kPoolSize = 1 << 22;
+    std::string pool;
+    
+    ValuePool() {
+        static const char kChars[] = "abcdefghijklmnopqrstuvwxyz0123456789";
+        FastRandom rng(0x5eed);
+        pool.resize(kPoolSize);
+        for (char& c : pool) {
+            c = kChars[rng.below(sizeof(kChars) - 1)];
+        }
+    }
+
+public:
+    static const ValuePool& instance() {
+        static const ValuePool pool_instance;
+        return pool_instance;
+    }
+    
+    void append(std::string& out, size_t length, FastRandom& rng) const {
+        while (length > 0) {
+            size_t chunk = std::min(length, kPoolSize / 2);
+            out.append(pool, rng.below(kPoolSize - chunk + 1), chunk);
+            length -= chunk;
+        }
+    }
+    
+    std::string make(size_t length, FastRandom& rng) const {
+        std::string value;
+        value.reserve(length);
+        append(value, length, rng);
+        return value;
+    }
+};
+
+// Drives many non-blocking connections from a few threads with epoll. Each
+// connection sends a pipeline of `pipeline` commands, waits for all replies,
+// optionally sleeps for the think time, and repeats.
+class EventLoopEngine {
+public:
+    struct Options {
+        int connections = 1000;
+        int threads = 2;
+        int pipeline = 1;
+        int think_time_us = 0;
+        int duration_seconds = 5;
+    };
+    
+    struct Result {
+        long connected = 0;
+        long completed = 0;
+        long errors = 0;
+        double elapsed_seconds = 0;
+        HdrHistogram latency_ns;
+    };
+
+private:
+    using Clock = std::chrono::steady_clock;
+    
+    struct Connection {
+        int fd = -1;
+        std::string out;
+        size_t out_offset = 0;
+        std::string in;
+        std::deque<Clock::time_point> sent_at;
+        bool writing = false;
+    };
+    
+    struct ThreadResult {
+        long connected = 0;
+        long completed = 0;
+        long errors = 0;
+        HdrHistogram latency_ns;
+    };
+    
+    Options options;
+    std::function<std::string(FastRandom&)> next_command;
+    
+    static int open_connection() {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) return -1;
+        
+        sockaddr_in server_addr;
+        server_addr.sin_family = AF_INET;
+        server_addr.sin_port = htons(6379);
+        inet_pton(AF_INET, "127.0.0.1", &server_addr.sin_addr);
+        if (connect(fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
+            close(fd);
+            return -1;
+        }
+        
+        int nodelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        return fd;
+    }
+    
+    void watch(int epoll_fd, Connection& conn, size_t index, bool writable) {
+        epoll_event event{};
+        event.events = writable ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+        event.data.u64 = index;
+        epoll_ctl(epoll_fd, EPOLL_CTL_MOD, conn.fd, &event);
+        conn.writing = writable;
+    }
+    
+    // Returns false if the connection failed.
+    bool flush_output(int epoll_fd, Connection& conn, size_t index) {
+        while (conn.out_offset < conn.out.size()) {
+            ssize_t sent = send(conn.fd, conn.out.data() + conn.out_offset, conn.out.size() - conn.out_offset, MSG_NOSIGNAL);
+            if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                if (!conn.writing) watch(epoll_fd, conn, index, true);
+                return true;
+            }
+            if (sent <= 0) return false;
+            conn.out_offset += sent;
+        }
+        conn.out.clear();
+        conn.out_offset = 0;
+        if (conn.writing) watch(epoll_fd, conn, index, false);
+        return true;
+    }
+    
+    bool send_batch(int epoll_fd, Connection& conn, size_t index, FastRandom& gen) {
+        auto now = Clock::now();
+        for (int i = 0; i < options.pipeline; ++i) {
+            append_resp_command(conn.out, next_command(gen));
+            conn.sent_at.push_back(now);
+        }
+        return flush_output(epoll_fd, conn, index);
+    }
+    
+    void run_thread(int thread_index, int connection_count, Clock::time_point end, ThreadResult& result) {
+        int epoll_fd = epoll_create1(0);
+        if (epoll_fd < 0) return;
+        
+        FastRandom gen(thread_index + 1);
+        std::vector<Connection> conns(connection_count);
+        using Wakeup = std::pair<Clock::time_point, size_t>;
+        std::priority_queue<Wakeup, std::vector<Wakeup>, std::greater<Wakeup>> sleeping;
         
-        std::string full_command = command + "\r\n";
-        ssize_t sent = send(sock_fd, full_command.c_str(), full_command.length(), 0);
-        if (sent <= 0) return false;
+        for (size_t i = 0; i < conns.size(); ++i) {
+            conns[i].fd = open_connection();
+            if (conns[i].fd < 0) {
+                result.errors++;
+                continue;
+            }
+            result.connected++;
+            
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.u64 = i;
+            epoll_ctl(epoll_fd, EPOLL_CTL_ADD, conns[i].fd, &event);
+            if (!send_batch(epoll_fd, conns[i], i, gen)) result.errors++;
+        }
+        
+        std::vector<epoll_event> events(256);
+        char buffer[16384];
+        while (Clock::now() < end) {
+            auto now = Clock::now();
+            while (!sleeping.empty() && sleeping.top().first <= now) {
+                size_t index = sleeping.top().second;
+                sleeping.pop();
+                if (!send_batch(epoll_fd, conns[index], index, gen)) result.errors++;
+            }
+            
+            int timeout_ms = 10;
+            if (!sleeping.empty()) {
+                auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(sleeping.top().first - now).count();
+                timeout_ms = static_cast<int>(std::min<long long>(timeout_ms, std::max<long long>(0, wait)));
+            }
+            
+            int ready = epoll_wait(epoll_fd, events.data(), static_cast<int>(events.size()), timeout_ms);
+            for (int e = 0; e < ready; ++e) {
+                size_t index = events[e].data.u64;
+                Connection& conn = conns[index];
+                if (conn.fd < 0) continue;
+                
+                bool alive = true;
+                if (events[e].events & EPOLLOUT) {
+                    alive = flush_output(epoll_fd, conn, index);
+                }
+                if (alive && (events[e].events & (EPOLLIN | EPOLLHUP | EPOLLERR))) {
+                    while (true) {
+                        ssize_t received = recv(conn.fd, buffer, sizeof(buffer), 0);
+                        if (received > 0) {
+                            conn.in.append(buffer, received);
+                            continue;
+                        }
+                        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+                        alive = false;
+                        break;
+                    }
+                    
+                    auto received_at = Clock::now();
+                    size_t consumed = 0;
+                    while (!conn.sent_at.empty()) {
+                        bool is_error = false;
+                        size_t next = parse_reply(conn.in, consumed, is_error);
+                        if (next == std::string::npos) break;
+                        consumed = next;
+                        
+                        result.latency_ns.record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            received_at - conn.sent_at.front()).count());
+                        conn.sent_at.pop_front();
+                        if (is_error) result.errors++;
+                        result.completed++;
+                    }
+                    conn.in.erase(0, consumed);
+                    
+                    if (alive && conn.sent_at.empty()) {
+                        if (options.think_time_us > 0) {
+                            sleeping.emplace(received_at + std::chrono::microseconds(options.think_time_us), index);
+                        } else if (!send_batch(epoll_fd, conn, index, gen)) {
+                            alive = false;
+                        }
+                    }
+                }
+                
+                if (!alive) {
+                    result.errors += conn.sent_at.size() + 1;
+                    conn.sent_at.clear();
+                    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, conn.fd, nullptr);
+                    close(conn.fd);
+                    conn.fd = -1;
+                }
+            }
+        }
+        
+        for (auto& conn : conns) {
+            if (conn.fd >= 0) close(conn.fd);
+        }
+        close(epoll_fd);
+    }
+
+public:
+    EventLoopEngine(const Options& engine_options, std::function<std::string(FastRandom&)> generator)
+        : options(engine_options), next_command(std::move(generator)) {}
+    
+    Result run() {
+        // Thousands of sockets need more than the usual soft limit of 1024 fds.
+        rlimit limit;
+        if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+            limit.rlim_cur = limit.rlim_max;
+            setrlimit(RLIMIT_NOFILE, &limit);
+        }
+        
+        int threads = std::max(1, std::min(options.threads, options.connections));
+        std::vector<ThreadResult> results(threads);
+        auto start = Clock::now();
+        auto end = start + std::chrono::seconds(options.duration_seconds);
+        
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            int count = options.connections / threads + (t < options.connections % threads ? 1 : 0);
+            workers.emplace_back(&EventLoopEngine::run_thread, this, t, count, end, std::ref(results[t]));
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        
+        Result result;
+        result.elapsed_seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        for (const auto& thread_result : results) {
+            result.connected += thread_result.connected;
+            result.completed += thread_result.completed;
+            result.errors += thread_result.errors;
+            result.latency_ns.merge(thread_result.latency_ns);
+        }
+        return result;
+    }
+};
+
+// Picks key ids in [0, keyspace). Zipf uses Gray et al.'s generator with
+// ranks scrambled by an FNV hash (as YCSB does), so hot keys are spread over
+// the table rather than clustered at low ids. "latest" is Zipf without
+// scrambling, counted back from the most recently preloaded key.
+class KeyDistribution {
+public:
+    enum Kind { UNIFORM, ZIPF, HOTSPOT, LATEST };
+
+private:
+    Kind kind = UNIFORM;
+    uint64_t keyspace = 1000;
+    double theta = 0.99;
+    double hot_key_fraction = 0.2;
+    double hot_op_fraction = 0.8;
+    double zetan = 0, eta = 0, alpha = 0;
+    
+    static double zeta(uint64_t n, double theta) {
+        // Exact up to kExactTerms, Euler-Maclaurin tail beyond that so that
+        // 100M-key keyspaces don't need 100M pow() calls.
+        const uint64_t kExactTerms = 1000000;
+        double sum = 0;
+        uint64_t exact = std::min(n, kExactTerms);
+        for (uint64_t i = 1; i <= exact; ++i) {
+            sum += 1.0 / std::pow(static_cast<double>(i), theta);
+        }
+        if (n > exact) {
+            double a = static_cast<double>(exact), b = static_cast<double>(n);
+            sum += (std::pow(b, 1 - theta) - std::pow(a, 1 - theta)) / (1 - theta) +
+                   (std::pow(b, -theta) - std::pow(a, -theta)) / 2;
+        }
+        return sum;
+    }
+    
+    static uint64_t fnv_hash(uint64_t value) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (int i = 0; i < 8; ++i) {
+            hash ^= value & 0xff;
+            hash *= 0x100000001b3ULL;
+            value >>= 8;
+        }
+        return hash;
+    }
+    
+    uint64_t next_zipf_rank(FastRandom& gen) const {
+        double u = gen.uniform();
+        double uz = u * zetan;
+        if (uz < 1.0) return 0;
+        if (uz < 1.0 + std::pow(0.5, theta)) return std::min<uint64_t>(1, keyspace - 1);
+        auto rank = static_cast<uint64_t>(keyspace * std::pow(eta * u - eta + 1, alpha));
+        return std::min(rank, keyspace - 1);
+    }
+
+public:
+    // spec: uniform | zipf[:theta] | hotspot[:key_fraction:op_fraction] | latest[:theta]
+    bool configure(const std::string& spec, uint64_t keys) {
+        keyspace = std::max<uint64_t>(1, keys);
+        std::vector<double> params;
+        std::string name = spec.substr(0, spec.find(':'));
+        for (size_t pos = spec.find(':'); pos != std::string::npos; pos = spec.find(':', pos + 1)) {
+            params.push_back(std::atof(spec.c_str() + pos + 1));
+        }
+        
+        if (name == "uniform") {
+            kind = UNIFORM;
+        } else if (name == "zipf" || name == "latest") {
+            kind = name == "zipf" ? ZIPF : LATEST;
+            if (!params.empty()) theta = params[0];
+            if (theta <= 0 || theta >= 1) return false;
+            zetan = zeta(keyspace, theta);
+            alpha = 1.0 / (1.0 - theta);
+            eta = (1 - std::pow(2.0 / keyspace, 1 - theta)) / (1 - zeta(2, theta) / zetan);
+        } else if (name == "hotspot") {
+            kind = HOTSPOT;
+            if (params.size() > 0) hot_key_fraction = params[0];
+            if (params.size() > 1) hot_op_fraction = params[1];
+            if (hot_key_fraction <= 0 || hot_key_fraction >= 1 || hot_op_fraction < 0 || hot_op_fraction > 1) return false;
+        } else {
+            return false;
+        }
+        return true;
+    }
+    
+    uint64_t next(FastRandom& gen) const {
+        switch (kind) {
+            case ZIPF:
+                return fnv_hash(next_zipf_rank(gen)) % keyspace;
+            case LATEST:
+                return keyspace - 1 - next_zipf_rank(gen);
+            case HOTSPOT: {
+                uint64_t hot_keys = std::max<uint64_t>(1, static_cast<uint64_t>(keyspace * hot_key_fraction));
+                bool hot = gen.uniform() < hot_op_fraction;
+                if (hot || hot_keys == keyspace) {
+                    return gen.below(hot_keys);
+                }
+                return gen.between(hot_keys, keyspace - 1);
+            }
+            case UNIFORM:
+            default:
+                return gen.below(keyspace);
+        }
+    }
+    
+    uint64_t size() const {
+        return keyspace;
+    }
+};
+
+// Value sizes: "n" for a fixed size or "min-max" for a uniform range.
+class ValueSizeDistribution {
+private:
+    size_t min_size = 16;
+    size_t max_size = 16;
+
+public:
+    bool configure(const std::string& spec) {
+        size_t dash = spec.find('-');
+        long long low = std::atoll(spec.c_str());
+        long long high = dash == std::string::npos ? low : std::atoll(spec.c_str() + dash + 1);
+        if (low <= 0 || high < low) return false;
+        min_size = low;
+        max_size = high;
+        return true;
+    }
+    
+    size_t next(FastRandom& gen) const {
+        if (min_size == max_size) return min_size;
+        return gen.between(min_size, max_size);
+    }
+    
+    std::string describe() const {
+        return min_size == max_size ? std::to_string(min_size) : std::to_string(min_size) + "-" + std::to_string(max_size);
+    }
+};
+
+// Weighted command mix, e.g. "GET:70 SET:20 SETEX:5 HGET:5".
+class CommandMix {
+public:
+    enum Op {
+        OP_GET, OP_SET, OP_SETEX, OP_DEL, OP_EXISTS, OP_EXPIRE, OP_TTL,
+        OP_LPUSH, OP_RPUSH, OP_LPOP, OP_RPOP, OP_LLEN, OP_LRANGE,
+        OP_HSET, OP_HGET, OP_HDEL, OP_HGETALL,
+        OP_SADD, OP_SREM, OP_SMEMBERS, OP_SCARD,
+        OP_PUBLISH,
+        OP_COUNT
+    };
+    
+    static const char* op_name(int op) {
+        static const char* const names[OP_COUNT] = {
+            "GET", "SET", "SETEX", "DEL", "EXISTS", "EXPIRE", "TTL",
+            "LPUSH", "RPUSH", "LPOP", "RPOP", "LLEN", "LRANGE",
+            "HSET", "HGET", "HDEL", "HGETALL",
+            "SADD", "SREM", "SMEMBERS", "SCARD",
+            "PUBLISH"
+        };
+        return names[op];
+    }
+
+private:
+    std::vector<std::pair<Op, double>> cumulative;
+    double total_weight = 0;
+
+public:
+    bool parse(const std::string& spec, std::string& error) {
+        cumulative.clear();
+        total_weight = 0;
+        
+        std::istringstream iss(spec);
+        std::string entry;
+        while (iss >> entry) {
+            size_t colon = entry.find(':');
+            std::string name = entry.substr(0, colon);
+            std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+            double weight = colon == std::string::npos ? 1.0 : std::atof(entry.c_str() + colon + 1);
+            
+            int op = 0;
+            while (op < OP_COUNT && name != op_name(op)) ++op;
+            if (op == OP_COUNT) {
+                error = "unknown command in mix: " + name;
+                return false;
+            }
+            if (weight <= 0) {
+                error = "weight must be positive: " + entry;
+                return false;
+            }
+            total_weight += weight;
+            cumulative.emplace_back(static_cast<Op>(op), total_weight);
+        }
+        if (cumulative.empty()) {
+            error = "empty command mix";
+            return false;
+        }
+        return true;
+    }
+    
+    Op next(FastRandom& gen) const {
+        double pick = gen.uniform() * total_weight;
+        for (const auto& entry : cumulative) {
+            if (pick < entry.second) return entry.first;
+        }
+        return cumulative.back().first;
+    }
+    
+    bool empty() const {
+        return cumulative.empty();
+    }
+    
+    std::string describe() const {
+        std::string text;
+        double previous = 0;
+        for (const auto& entry : cumulative) {
+            if (!text.empty()) text += " ";
+            text += op_name(entry.first) + std::string(":") +
+                    std::to_string(static_cast<int>(std::round((entry.second - previous) * 100 / total_weight))) + "%";
+            previous = entry.second;
+        }
+        return text;
+    }
+};
+
+// One phase of a scenario. Zero/empty fields inherit the scenario defaults.
+struct WorkloadPhase {
+    std::string name;
+    int duration_seconds = 10;
+    double rate = 0;
+    int connections = 0;
+    int pipeline = 0;
+    int think_time_us = -1;
+    std::string key_dist;
+    CommandMix mix;
+};
+
+// Scenario file format: "key = value" lines, '#' comments, a [scenario]
+// section for defaults and one [phase <name>] section per phase, run in order.
+// See workloads/ for examples.
+struct WorkloadScenario {
+    std::string name = "scenario";
+    uint64_t keyspace = 1000;
+    std::string key_dist = "uniform";
+    std::string value_size = "16";
+    bool preload = true;
+    int connections = 4;
+    int threads = 2;
+    int pipeline = 1;
+    int think_time_us = 0;
+    int ttl_min = 60;
+    int ttl_max = 60;
+    std::vector<WorkloadPhase> phases;
+    
+    bool load(const std::string& path, std::string& error) {
+        std::ifstream file(path);
+        if (!file) {
+            error = "cannot open " + path;
+            return false;
+        }
         
-        char buffer[1024];
-        ssize_t received = recv(sock_fd, buffer, sizeof(buffer) - 1, 0);
-        return received > 0;
+        std::string line;
+        int line_number = 0;
+        WorkloadPhase* phase = nullptr;
+        while (std::getline(file, line)) {
+            ++line_number;
+            line = trim(line.substr(0, line.find('#')));
+            if (line.empty()) continue;
+            
+            auto fail = [&](const std::string& message) {
+                error = path + ":" + std::to_string(line_number) + ": " + message;
+                return false;
+            };
+            
+            if (line.front() == '[') {
+                if (line.back() != ']') return fail("unterminated section header");
+                std::string header = trim(line.substr(1, line.size() - 2));
+                if (header == "scenario") {
+                    phase = nullptr;
+                } else if (header.compare(0, 5, "phase") == 0) {
+                    phases.emplace_back();
+                    phase = &phases.back();
+                    phase->name = trim(header.substr(5));
+                    if (phase->name.empty()) phase->name = "phase" + std::to_string(phases.size());
+                } else {
+                    return fail("unknown section [" + header + "]");
+                }
+                continue;
+            }
+            
+            size_t equals = line.find('=');
+            if (equals == std::string::npos) return fail("expected key = value");
+            std::string key = trim(line.substr(0, equals));
+            std::string value = trim(line.substr(equals + 1));
+            
+            if (phase) {
+                if (key == "duration") phase->duration_seconds = std::max(1, std::atoi(value.c_str()));
+                else if (key == "rate") phase->rate = std::atof(value.c_str());
+                else if (key == "connections") phase->connections = std::atoi(value.c_str());
+                else if (key == "pipeline") phase->pipeline = std::atoi(value.c_str());
+                else if (key == "think-us") phase->think_time_us = std::atoi(value.c_str());
+                else if (key == "key-dist") phase->key_dist = value;
+                else if (key == "mix") {
+                    std::string mix_error;
+                    if (!phase->mix.parse(value, mix_error)) return fail(mix_error);
+                } else {
+                    return fail("unknown phase setting '" + key + "'");
+                }
+                continue;
+            }
+            
+            if (key == "name") name = value;
+            else if (key == "keyspace") keyspace = std::strtoull(value.c_str(), nullptr, 10);
+            else if (key == "key-dist") key_dist = value;
+            else if (key == "value-size") value_size = value;
+            else if (key == "preload") preload = value == "yes" || value == "true" || value == "1";
+            else if (key == "connections") connections = std::max(1, std::atoi(value.c_str()));
+            else if (key == "threads") threads = std::max(1, std::atoi(value.c_str()));
+            else if (key == "pipeline") pipeline = std::max(1, std::atoi(value.c_str()));
+            else if (key == "think-us") think_time_us = std::max(0, std::atoi(value.c_str()));
+            else if (key == "ttl") {
+                size_t dash = value.find('-');
+                ttl_min = std::atoi(value.c_str());
+                ttl_max = dash == std::string::npos ? ttl_min : std::atoi(value.c_str() + dash + 1);
+                if (ttl_min <= 0 || ttl_max < ttl_min) return fail("invalid ttl '" + value + "'");
+            } else {
+                return fail("unknown scenario setting '" + key + "'");
+            }
+        }
+        
+        if (phases.empty()) {
+            error = path + ": no [phase] sections";
+            return false;
+        }
+        for (const auto& phase_entry : phases) {
+            if (phase_entry.mix.empty()) {
+                error = path + ": phase '" + phase_entry.name + "' has no mix";
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    static std::string trim(const std::string& text) {
+        size_t first = text.find_first_not_of(" \t\r");
+        if (first == std::string::npos) return "";
+        size_t last = text.find_last_not_of(" \t\r");
+        return text.substr(first, last - first + 1);
     }
 };
 
+struct BenchmarkResult {
+    std::string name;
+    std::vector<std::pair<std::string, double>> metrics;
+};
+
+std::string json_escape(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+bool write_results_json(const std::string& path, const std::vector<BenchmarkResult>& results) {
+    std::ofstream out(path);
+    if (!out) return false;
+    
+    out << std::setprecision(10) << "{\n  \"results\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        out << (i ? ",\n" : "\n") << "    {\"name\": \"" << json_escape(results[i].name) << "\", \"metrics\": {";
+        for (size_t m = 0; m < results[i].metrics.size(); ++m) {
+            out << (m ? ", " : "") << "\"" << json_escape(results[i].metrics[m].first) << "\": "
+                << results[i].metrics[m].second;
+        }
+        out << "}}";
+    }
+    out << "\n  ]\n}\n";
+    return static_cast<bool>(out);
+}
+
+bool write_results_csv(const std::string& path, const std::vector<BenchmarkResult>& results) {
+    std::ofstream out(path);
+    if (!out) return false;
+    
+    out << std::setprecision(10) << "name,metric,value\n";
+    for (const auto& result : results) {
+        for (const auto& metric : result.metrics) {
+            out << result.name << "," << metric.first << "," << metric.second << "\n";
+        }
+    }
+    return static_cast<bool>(out);
+}
+
+// Reads files written by write_results_json or write_results_csv. The JSON
+// reader only understands that shape: every "name" string starts a result and
+// every numeric member after it is one of its metrics.
+bool load_results(const std::string& path, std::vector<BenchmarkResult>& results) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    
+    size_t start = text.find_first_not_of(" \t\r\n");
+    if (start != std::string::npos && text[start] != '{') {
+        std::istringstream lines(text);
+        std::string line;
+        std::getline(lines, line);
+        while (std::getline(lines, line)) {
+            size_t first = line.find(','), second = line.rfind(',');
+            if (first == std::string::npos || first == second) continue;
+            std::string name = line.substr(0, first);
+            if (results.empty() || results.back().name != name) results.push_back({name, {}});
+            results.back().metrics.emplace_back(line.substr(first + 1, second - first - 1),
+                                                std::atof(line.c_str() + second + 1));
+        }
+        return true;
+    }
+    
+    auto read_string = [&](size_t& pos) {
+        std::string value;
+        for (++pos; pos < text.size() && text[pos] != '"'; ++pos) {
+            if (text[pos] == '\\' && pos + 1 < text.size()) ++pos;
+            value += text[pos];
+        }
+        ++pos;
+        return value;
+    };
+    
+    size_t pos = 0;
+    while ((pos = text.find('"', pos)) != std::string::npos) {
+        std::string key = read_string(pos);
+        size_t colon = text.find_first_not_of(" \t\r\n", pos);
+        if (colon == std::string::npos || text[colon] != ':') continue;
+        size_t value = text.find_first_not_of(" \t\r\n", colon + 1);
+        if (value == std::string::npos) break;
+        
+        if (key == "name" && text[value] == '"') {
+            pos = value;
+            results.push_back({read_string(pos), {}});
+        } else if (!results.empty() && (isdigit(static_cast<unsigned char>(text[value])) || text[value] == '-')) {
+            char* end;
+            results.back().metrics.emplace_back(key, std::strtod(text.c_str() + value, &end));
+            pos = end - text.c_str();
+        } else {
+            pos = value;
+        }
+    }
+    return true;
+}
+
+// +1 when higher is better, -1 when lower is better, 0 for informational metrics.
+int metric_direction(const std::string& metric) {
+    if (metric.find("ops_per_sec") != std::string::npos || metric.find("success") != std::string::npos) return 1;
+    if (metric.find("_ms") != std::string::npos || metric.find("errors") != std::string::npos ||
+        metric.find("per_op") != std::string::npos) return -1;
+    return 0;
+}
+
+// Prints every metric present in both files and returns the number of
+// regressions larger than threshold_pct.
+int compare_results(const std::string& base_path, const std::string& current_path, double threshold_pct) {
+    std::vector<BenchmarkResult> base, current;
+    if (!load_results(base_path, base) || !load_results(current_path, current)) {
+        std::cout << "Cannot read " << base_path << " or " << current_path << std::endl;
+        return -1;
+    }
+    
+    std::cout << std::left << std::setw(28) << "benchmark" << std::setw(26) << "metric" << std::right
+              << std::setw(14) << "base" << std::setw(14) << "current" << std::setw(10) << "change" << std::endl;
+    
+    int regressions = 0;
+    for (const auto& result : current) {
+        auto base_result = std::find_if(base.begin(), base.end(),
+                                        [&](const BenchmarkResult& other) { return other.name == result.name; });
+        if (base_result == base.end()) continue;
+        
+        for (const auto& metric : result.metrics) {
+            auto base_metric = std::find_if(base_result->metrics.begin(), base_result->metrics.end(),
+                                            [&](const std::pair<std::string, double>& other) { return other.first == metric.first; });
+            if (base_metric == base_result->metrics.end()) continue;
+            
+            double before = base_metric->second, after = metric.second;
+            double change = before != 0 ? (after - before) * 100.0 / std::fabs(before) : (after != 0 ? 100.0 : 0.0);
+            int direction = metric_direction(metric.first);
+            bool regressed = direction != 0 && -direction * change > threshold_pct;
+            regressions += regressed ? 1 : 0;
+            
+            std::cout << std::left << std::setw(28) << result.name << std::setw(26) << metric.first << std::right
+                      << std::fixed << std::setprecision(3) << std::setw(14) << before << std::setw(14) << after
+                      << std::setprecision(1) << std::setw(9) << change << "%" << (regressed ? "  REGRESSION" : "")
+                      << std::endl;
+        }
+    }
+    
+    std::cout << "\n" << regressions << " regression(s) beyond " << threshold_pct << "%" << std::endl;
+    return regressions;
+}
+
 class PerformanceBenchmark {
 private:
     std::atomic<long> total_operations{0};
     std::atomic<long> successful_operations{0};
     std::atomic<long> failed_operations{0};
+    int pipeline_depth = 1;
+    KeyDistribution key_distribution;
+    ValueSizeDistribution value_sizes;
+    std::string key_distribution_spec = "uniform";
+    bool preload_enabled = true;
+    bool keyspace_loaded = false;
+    std::vector<BenchmarkResult> results;
     
-    std::string generate_random_string(int length) {
-        const std::string chars = "abcdefghijklmnopqrstuvwxyz0123456789";
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<> dis(0, chars.size() - 1);
+    using RunSnapshot = std::map<std::string, double>;
+    
+    // Numeric fields from the server's default INFO sections, plus this
+    // process's own CPU time as client_cpu_sec.
+    RunSnapshot take_snapshot() {
+        RunSnapshot snapshot;
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        snapshot["client_cpu_sec"] = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+                                     usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+        
+        BenchmarkClient client;
+        if (!client.connect_to_server()) return snapshot;
         
-        std::string result;
-        result.reserve(length);
-        for (int i = 0; i < length; ++i) {
-            result += chars[dis(gen)];
+        std::istringstream reply(client.query("INFO"));
+        std::string line;
+        while (std::getline(reply, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            size_t colon = line.find(':');
+            if (colon == std::string::npos || line[0] == '#') continue;
+            
+            char* end;
+            double value = std::strtod(line.c_str() + colon + 1, &end);
+            if (end != line.c_str() + colon + 1 && *end == '\0') {
+                snapshot[line.substr(0, colon)] = value;
+            }
         }
-        return result;
+        return snapshot;
+    }
+    
+    static void add_latency_metrics(std::vector<std::pair<std::string, double>>& metrics, const HdrHistogram& latency_ns) {
+        metrics.emplace_back("p50_ms", latency_ns.percentile(50.0) / 1e6);
+        metrics.emplace_back("p90_ms", latency_ns.percentile(90.0) / 1e6);
+        metrics.emplace_back("p99_ms", latency_ns.percentile(99.0) / 1e6);
+        metrics.emplace_back("p99_9_ms", latency_ns.percentile(99.9) / 1e6);
+        metrics.emplace_back("max_ms", latency_ns.max() / 1e6);
+    }
+    
+    // Records a result, adding server-side deltas (CPU, memory, commands)
+    // between `before` and now.
+    void add_result(const std::string& name, std::vector<std::pair<std::string, double>> metrics,
+                    const RunSnapshot& before, double operations) {
+        RunSnapshot after = take_snapshot();
+        auto has = [&](const char* key) { return before.count(key) && after.count(key); };
+        
+        if (has("used_cpu_user") && has("used_cpu_sys")) {
+            double cpu = after["used_cpu_user"] + after["used_cpu_sys"] -
+                         before.at("used_cpu_user") - before.at("used_cpu_sys");
+            metrics.emplace_back("server_cpu_sec", cpu);
+            if (operations > 0) metrics.emplace_back("server_cpu_us_per_op", cpu * 1e6 / operations);
+        }
+        if (has("client_cpu_sec") && operations > 0) {
+            double client_us = (after["client_cpu_sec"] - before.at("client_cpu_sec")) * 1e6 / operations;
+            metrics.emplace_back("client_cpu_us_per_op", client_us);
+            
+            // Self-check: if generating and parsing a request costs the client
+            // more CPU than serving it costs the server, the numbers above
+            // describe the benchmark rather than the server.
+            std::cout << "Client CPU: " << std::fixed << std::setprecision(2) << client_us << " us/op";
+            if (has("used_cpu_user") && has("used_cpu_sys")) {
+                double server_us = (after["used_cpu_user"] + after["used_cpu_sys"] -
+                                    before.at("used_cpu_user") - before.at("used_cpu_sys")) * 1e6 / operations;
+                std::cout << ", server CPU: " << server_us << " us/op";
+                if (client_us > server_us) {
+                    std::cout << " (warning: client-bound, results understate the server)";
+                }
+            }
+            std::cout << std::endl;
+        }
+        if (has("used_memory_rss")) {
+            metrics.emplace_back("server_rss_bytes", after["used_memory_rss"]);
+            metrics.emplace_back("server_rss_delta_bytes", after["used_memory_rss"] - before.at("used_memory_rss"));
+        }
+        if (has("total_commands_processed")) {
+            metrics.emplace_back("server_commands", after["total_commands_processed"] - before.at("total_commands_processed"));
+        }
+        results.push_back({name, std::move(metrics)});
+    }
+    
+    void add_throughput_result(const std::string& name, const RunSnapshot& before, long duration_ms) {
+        double seconds = std::max<long>(1, duration_ms) / 1000.0;
+        add_result(name, {
+            {"throughput_ops_per_sec", total_operations.load() / seconds},
+            {"operations", static_cast<double>(total_operations.load())},
+            {"errors", static_cast<double>(failed_operations.load())},
+            {"duration_sec", seconds}
+        }, before, total_operations.load());
+    }
+    
+    static std::string key_name(uint64_t id) {
+        return "key:" + std::to_string(id);
     }
     
+    std::string make_value(FastRandom& gen) const {
+        return ValuePool::instance().make(value_sizes.next(gen), gen);
+    }
+    
+    void flush_batch(BenchmarkClient& client) {
+        long sent = client.pending();
+        int ok = client.flush();
+        if (ok < 0) ok = 0;
+        successful_operations += ok;
+        failed_operations += sent - ok;
+        total_operations += sent;
+    }
+
 public:
+    PerformanceBenchmark() {
+        key_distribution.configure(key_distribution_spec, 1000);
+    }
+    
+    void set_pipeline_depth(int depth) {
+        pipeline_depth = std::max(1, depth);
+    }
+    
+    bool configure_workload(uint64_t keyspace, const std::string& key_spec, const std::string& value_spec, bool preload) {
+        if (keyspace == 0 || keyspace > 100000000ULL) {
+            std::cout << "Keyspace must be between 1 and 100000000" << std::endl;
+            return false;
+        }
+        if (!key_distribution.configure(key_spec, keyspace)) {
+            std::cout << "Invalid key distribution: " << key_spec << std::endl;
+            return false;
+        }
+        if (!value_sizes.configure(value_spec)) {
+            std::cout << "Invalid value size: " << value_spec << std::endl;
+            return false;
+        }
+        key_distribution_spec = key_spec;
+        preload_enabled = preload;
+        return true;
+    }
+    
+    bool write_results(const std::string& json_path, const std::string& csv_path) const {
+        bool ok = true;
+        if (!json_path.empty() && !write_results_json(json_path, results)) {
+            std::cout << "Failed to write " << json_path << std::endl;
+            ok = false;
+        }
+        if (!csv_path.empty() && !write_results_csv(csv_path, results)) {
+            std::cout << "Failed to write " << csv_path << std::endl;
+            ok = false;
+        }
+        return ok;
+    }
+    
+    void print_workload() const {
+        std::cout << "Keyspace: " << key_distribution.size() << " keys, distribution: " << key_distribution_spec
+                  << ", value size: " << value_sizes.describe() << " bytes" << std::endl;
+    }
+    
     void run_set_benchmark(int num_threads, int operations_per_thread, int key_size, int value_size) {
         std::cout << "\n=== SET Benchmark ===" << std::endl;
-        std::cout << "Threads: " << num_threads << ", Operations per thread: " << operations_per_thread << std::endl;
+        std::cout << "Threads: " << num_threads << ", Operations per thread: " << operations_per_thread
+                  << ", Pipeline: " << pipeline_depth << std::endl;
         std::cout << "Key size: " << key_size << " bytes, Value size: " << value_size << " bytes" << std::endl;
         
+        RunSnapshot before = take_snapshot();
         auto start_time = std::chrono::high_resolution_clock::now();
         
         std::vector<std::thread> threads;
@@ -88,21 +1230,23 @@ public:
                     return;
                 }
                 
+                const ValuePool& pool = ValuePool::instance();
+                FastRandom gen(std::random_device{}());
+                std::string command;
+                
                 for (int i = 0; i < operations_per_thread; ++i) {
-                    std::string key = "bench_key_" + std::to_string(t) + "_" + std::to_string(i);
-                    if (key.length() < key_size) {
-                        key += generate_random_string(key_size - key.length());
+                    command = "SET bench_key_" + std::to_string(t) + "_" + std::to_string(i);
+                    size_t key_length = command.size() - 4;
+                    if (key_length < static_cast<size_t>(key_size)) {
+                        pool.append(command, key_size - key_length, gen);
                     }
+                    command += ' ';
+                    pool.append(command, value_size, gen);
                     
-                    std::string value = generate_random_string(value_size);
-                    std::string command = "SET " + key + " " + value;
-                    
-                    if (client.send_command_fast(command)) {
-                        successful_operations++;
-                    } else {
-                        failed_operations++;
+                    client.queue_command(command);
+                    if (client.pending() >= static_cast<size_t>(pipeline_depth) || i + 1 == operations_per_thread) {
+                        flush_batch(client);
                     }
-                    total_operations++;
                 }
             });
         }
@@ -124,20 +1268,18 @@ public:
         std::cout << "Throughput: " << static_cast<int>(ops_per_second) << " ops/sec" << std::endl;
         std::cout << "Success rate: " << std::fixed << std::setprecision(2) << success_rate << "%" << std::endl;
         
+        add_throughput_result("set/" + std::to_string(num_threads) + "t", before, duration.count());
         reset_counters();
     }
     
     void run_get_benchmark(int num_threads, int operations_per_thread) {
         std::cout << "\n=== GET Benchmark ===" << std::endl;
-        std::cout << "Threads: " << num_threads << ", Operations per thread: " << operations_per_thread << std::endl;
+        std::cout << "Threads: " << num_threads << ", Operations per thread: " << operations_per_thread
+                  << ", Pipeline: " << pipeline_depth << std::endl;
         
-        BenchmarkClient setup_client;
-        setup_client.connect_to_server();
-        for (int i = 0; i < 1000; ++i) {
-            std::string command = "SET get_bench_key_" + std::to_string(i) + " value_" + std::to_string(i);
-            setup_client.send_command_fast(command);
-        }
+        preload_keyspace();
         
+        RunSnapshot before = take_snapshot();
         auto start_time = std::chrono::high_resolution_clock::now();
         
         std::vector<std::thread> threads;
@@ -149,20 +1291,15 @@ public:
                     return;
                 }
                 
-                std::random_device rd;
-                std::mt19937 gen(rd());
-                std::uniform_int_distribution<> dis(0, 999);
+                FastRandom gen(std::random_device{}());
                 
                 for (int i = 0; i < operations_per_thread; ++i) {
-                    int key_id = dis(gen);
-                    std::string command = "GET get_bench_key_" + std::to_string(key_id);
+                    std::string command = "GET " + key_name(key_distribution.next(gen));
                     
-                    if (client.send_command_fast(command)) {
-                        successful_operations++;
-                    } else {
-                        failed_operations++;
+                    client.queue_command(command);
+                    if (client.pending() >= static_cast<size_t>(pipeline_depth) || i + 1 == operations_per_thread) {
+                        flush_batch(client);
                     }
-                    total_operations++;
                 }
             });
         }
@@ -184,21 +1321,19 @@ public:
         std::cout << "Throughput: " << static_cast<int>(ops_per_second) << " ops/sec" << std::endl;
         std::cout << "Success rate: " << std::fixed << std::setprecision(2) << success_rate << "%" << std::endl;
         
+        add_throughput_result("get/" + std::to_string(num_threads) + "t", before, duration.count());
         reset_counters();
     }
     
     void run_mixed_benchmark(int num_threads, int operations_per_thread) {
         std::cout << "\n=== Mixed Operations Benchmark ===" << std::endl;
-        std::cout << "Threads: " << num_threads << ", Operations per thread: " << operations_per_thread << std::endl;
+        std::cout << "Threads: " << num_threads << ", Operations per thread: " << operations_per_thread
+                  << ", Pipeline: " << pipeline_depth << std::endl;
         std::cout << "Mix: 60% GET, 30% SET, 10% other operations" << std::endl;
         
-        BenchmarkClient setup_client;
-        setup_client.connect_to_server();
-        for (int i = 0; i < 1000; ++i) {
-            std::string command = "SET mixed_key_" + std::to_string(i) + " value_" + std::to_string(i);
-            setup_client.send_command_fast(command);
-        }
+        preload_keyspace();
         
+        RunSnapshot before = take_snapshot();
         auto start_time = std::chrono::high_resolution_clock::now();
         
         std::vector<std::thread> threads;
@@ -210,32 +1345,27 @@ public:
                     return;
                 }
                 
-                std::random_device rd;
-                std::mt19937 gen(rd());
-                std::uniform_int_distribution<> op_dis(1, 100);
-                std::uniform_int_distribution<> key_dis(0, 999);
+                FastRandom gen(std::random_device{}());
                 
                 for (int i = 0; i < operations_per_thread; ++i) {
-                    int op_type = op_dis(gen);
-                    int key_id = key_dis(gen);
+                    int op_type = static_cast<int>(gen.between(1, 100));
+                    uint64_t key_id = key_distribution.next(gen);
                     std::string command;
                     
                     if (op_type <= 60) {
-                        command = "GET mixed_key_" + std::to_string(key_id);
+                        command = "GET " + key_name(key_id);
                     } else if (op_type <= 90) {
-                        command = "SET mixed_key_" + std::to_string(key_id) + " new_value_" + std::to_string(i);
+                        command = "SET " + key_name(key_id) + " " + make_value(gen);
                     } else if (op_type <= 95) {
-                        command = "DEL mixed_key_" + std::to_string(key_id);
+                        command = "DEL " + key_name(key_id);
                     } else {
-                        command = "EXISTS mixed_key_" + std::to_string(key_id);
+                        command = "EXISTS " + key_name(key_id);
                     }
                     
-                    if (client.send_command_fast(command)) {
-                        successful_operations++;
-                    } else {
-                        failed_operations++;
+                    client.queue_command(command);
+                    if (client.pending() >= static_cast<size_t>(pipeline_depth) || i + 1 == operations_per_thread) {
+                        flush_batch(client);
                     }
-                    total_operations++;
                 }
             });
         }
@@ -257,11 +1387,12 @@ public:
         std::cout << "Throughput: " << static_cast<int>(ops_per_second) << " ops/sec" << std::endl;
         std::cout << "Success rate: " << std::fixed << std::setprecision(2) << success_rate << "%" << std::endl;
         
+        add_throughput_result("mixed/" + std::to_string(num_threads) + "t", before, duration.count());
         reset_counters();
     }
     
     void run_latency_test() {
-        std::cout << "\n=== Latency Test ===" << std::endl;
+        std::cout << "\n=== Latency Test (closed loop, round trip on an idle server) ===" << std::endl;
         
         BenchmarkClient client;
         if (!client.connect_to_server()) {
@@ -271,6 +1402,7 @@ public:
         
         std::vector<double> latencies;
         const int num_operations = 1000;
+        RunSnapshot before = take_snapshot();
         
         for (int i = 0; i < num_operations; ++i) {
             auto start = std::chrono::high_resolution_clock::now();
@@ -297,6 +1429,296 @@ public:
         std::cout << "P99 latency: " << std::fixed << std::setprecision(3) << p99 << " ms" << std::endl;
         std::cout << "Min latency: " << std::fixed << std::setprecision(3) << latencies.front() << " ms" << std::endl;
         std::cout << "Max latency: " << std::fixed << std::setprecision(3) << latencies.back() << " ms" << std::endl;
+        
+        add_result("latency_closed_loop", {
+            {"avg_ms", avg_latency}, {"p50_ms", p50}, {"p95_ms", p95}, {"p99_ms", p99}, {"max_ms", latencies.back()}
+        }, before, num_operations);
+    }
+    
+    struct OpenLoopResult {
+        double target_rate = 0;
+        double achieved_rate = 0;
+        long errors = 0;
+        HdrHistogram latency_ns;
+    };
+    
+    // Each connection sends on a fixed schedule and keeps one request in flight.
+    // Latency is measured from the time a request was due, not from the time it
+    // was actually sent, so a stalled server is charged for the requests that
+    // queued up behind the stall (no coordinated omission).
+    OpenLoopResult run_open_loop(int connections, double rate, int duration_seconds,
+                                 const std::function<std::string(FastRandom&)>& next_command) {
+        using Clock = std::chrono::steady_clock;
+        
+        OpenLoopResult result;
+        result.target_rate = rate;
+        std::vector<HdrHistogram> histograms(connections);
+        std::vector<long> errors(connections, 0);
+        
+        auto interval = std::chrono::nanoseconds(static_cast<long long>(1e9 * connections / rate));
+        auto start = Clock::now() + std::chrono::milliseconds(10);
+        auto end = start + std::chrono::seconds(duration_seconds);
+        
+        std::vector<std::thread> threads;
+        for (int t = 0; t < connections; ++t) {
+            threads.emplace_back([&, t]() {
+                BenchmarkClient client;
+                if (!client.connect_to_server()) {
+                    errors[t]++;
+                    return;
+                }
+                
+                FastRandom gen(t + 1);
+                auto intended = start + interval * t / connections;
+                
+                while (intended < end) {
+                    if (Clock::now() < intended) {
+                        std::this_thread::sleep_until(intended);
+                    }
+                    
+                    if (!client.send_command_fast(next_command(gen))) {
+                        errors[t]++;
+                    }
+                    
+                    auto done = Clock::now();
+                    histograms[t].record(std::chrono::duration_cast<std::chrono::nanoseconds>(done - intended).count());
+                    intended += interval;
+                }
+            });
+        }
+        
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        
+        auto elapsed = std::chrono::duration<double>(std::max(Clock::now(), end) - start).count();
+        for (int t = 0; t < connections; ++t) {
+            result.latency_ns.merge(histograms[t]);
+            result.errors += errors[t];
+        }
+        result.achieved_rate = result.latency_ns.count() / elapsed;
+        return result;
+    }
+    
+    void print_open_loop_header() {
+        std::cout << std::setw(12) << "target/s" << std::setw(12) << "achieved/s"
+                  << std::setw(10) << "p50 ms" << std::setw(10) << "p90 ms" << std::setw(10) << "p99 ms"
+                  << std::setw(10) << "p99.9 ms" << std::setw(10) << "max ms" << std::setw(8) << "errors" << std::endl;
+    }
+    
+    void add_open_loop_result(const std::string& name, const OpenLoopResult& result, const RunSnapshot& before) {
+        std::vector<std::pair<std::string, double>> metrics = {
+            {"target_ops_per_sec", result.target_rate},
+            {"throughput_ops_per_sec", result.achieved_rate},
+            {"errors", static_cast<double>(result.errors)}
+        };
+        add_latency_metrics(metrics, result.latency_ns);
+        add_result(name, std::move(metrics), before, result.latency_ns.count());
+    }
+    
+    void print_open_loop_row(const OpenLoopResult& result) {
+        auto ms = [&](uint64_t ns) { return ns / 1e6; };
+        const HdrHistogram& h = result.latency_ns;
+        std::cout << std::fixed << std::setprecision(0)
+                  << std::setw(12) << result.target_rate << std::setw(12) << result.achieved_rate
+                  << std::setprecision(3)
+                  << std::setw(10) << ms(h.percentile(50.0)) << std::setw(10) << ms(h.percentile(90.0))
+                  << std::setw(10) << ms(h.percentile(99.0)) << std::setw(10) << ms(h.percentile(99.9))
+                  << std::setw(10) << ms(h.max()) << std::setw(8) << result.errors << std::endl;
+    }
+    
+    // 80% GET / 20% SET with keys and value sizes from the configured distributions.
+    std::string next_mixed_command(FastRandom& gen) const {
+        uint64_t key_id = key_distribution.next(gen);
+        return gen.below(100) < 80
+            ? "GET " + key_name(key_id)
+            : "SET " + key_name(key_id) + " " + make_value(gen);
+    }
+    
+    // Writes every key in the keyspace once, from several pipelined
+    // connections, so reads hit and the server's table is at full size before
+    // measurement starts.
+    void preload_keyspace() {
+        if (!preload_enabled || keyspace_loaded) return;
+        keyspace_loaded = true;
+        
+        const int kLoaders = 4;
+        const size_t kBatch = 1000;
+        uint64_t keyspace = key_distribution.size();
+        std::atomic<uint64_t> next_key{0};
+        std::atomic<long> failed{0};
+        auto start = std::chrono::steady_clock::now();
+        
+        std::vector<std::thread> loaders;
+        for (int t = 0; t < kLoaders; ++t) {
+            loaders.emplace_back([&, t]() {
+                BenchmarkClient client;
+                if (!client.connect_to_server()) {
+                    failed++;
+                    return;
+                }
+                
+                FastRandom gen(t + 1);
+                uint64_t first;
+                while ((first = next_key.fetch_add(kBatch)) < keyspace) {
+                    uint64_t last = std::min<uint64_t>(first + kBatch, keyspace);
+                    for (uint64_t id = first; id < last; ++id) {
+                        client.queue_command("SET " + key_name(id) + " " + make_value(gen));
+                    }
+                    long sent = client.pending();
+                    int ok = client.flush();
+                    failed += sent - std::max(ok, 0);
+                }
+            });
+        }
+        for (auto& loader : loaders) {
+            loader.join();
+        }
+        
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Preloaded " << keyspace << " keys (" << value_sizes.describe() << " byte values) in "
+                  << std::fixed << std::setprecision(2) << elapsed << " s";
+        if (failed > 0) std::cout << ", " << failed.load() << " failed";
+        std::cout << std::endl;
+    }
+    
+    // Runs the open-loop workload at increasing rates and prints one row per
+    // rate: the resulting throughput vs. tail latency curve shows where the
+    // server saturates.
+    void run_rate_sweep(int connections, double from_rate, double to_rate, double step, int duration_seconds) {
+        std::cout << "\n=== Open-Loop Latency (80% GET / 20% SET, " << connections << " connections, "
+                  << duration_seconds << "s per rate) ===" << std::endl;
+        print_workload();
+        preload_keyspace();
+        print_open_loop_header();
+        
+        for (double rate = from_rate; rate <= to_rate; rate += step) {
+            RunSnapshot before = take_snapshot();
+            OpenLoopResult result = run_open_loop(connections, rate, duration_seconds,
+                                                  [this](FastRandom& gen) { return next_mixed_command(gen); });
+            print_open_loop_row(result);
+            add_open_loop_result("open_loop/" + std::to_string(static_cast<long>(rate)), result, before);
+            if (step <= 0) break;
+        }
+    }
+    
+    void run_event_loop(const EventLoopEngine::Options& options) {
+        std::cout << "\n=== Event-Loop Load (80% GET / 20% SET) ===" << std::endl;
+        std::cout << "Connections: " << options.connections << ", Threads: " << options.threads
+                  << ", Pipeline: " << options.pipeline << ", Think time: " << options.think_time_us << " us"
+                  << ", Duration: " << options.duration_seconds << " s" << std::endl;
+        print_workload();
+        preload_keyspace();
+        
+        RunSnapshot before = take_snapshot();
+        EventLoopEngine engine(options, [this](FastRandom& gen) { return next_mixed_command(gen); });
+        EventLoopEngine::Result result = engine.run();
+        print_event_loop_result(result);
+        add_event_loop_result("event_loop", result, before);
+    }
+    
+    void add_event_loop_result(const std::string& name, const EventLoopEngine::Result& result, const RunSnapshot& before) {
+        std::vector<std::pair<std::string, double>> metrics = {
+            {"throughput_ops_per_sec", result.completed / result.elapsed_seconds},
+            {"operations", static_cast<double>(result.completed)},
+            {"errors", static_cast<double>(result.errors)},
+            {"connections", static_cast<double>(result.connected)}
+        };
+        add_latency_metrics(metrics, result.latency_ns);
+        add_result(name, std::move(metrics), before, result.completed);
+    }
+    
+    void print_event_loop_result(const EventLoopEngine::Result& result) {
+        auto ms = [](uint64_t ns) { return ns / 1e6; };
+        std::cout << "Connected: " << result.connected << std::endl;
+        std::cout << "Completed: " << result.completed << std::endl;
+        std::cout << "Errors: " << result.errors << std::endl;
+        std::cout << "Throughput: " << static_cast<long>(result.completed / result.elapsed_seconds) << " ops/sec" << std::endl;
+        std::cout << std::fixed << std::setprecision(3)
+                  << "Latency p50/p99/p99.9/max: " << ms(result.latency_ns.percentile(50.0)) << " / "
+                  << ms(result.latency_ns.percentile(99.0)) << " / " << ms(result.latency_ns.percentile(99.9))
+                  << " / " << ms(result.latency_ns.max()) << " ms" << std::endl;
+    }
+    
+    std::string scenario_command(CommandMix::Op op, FastRandom& gen, const KeyDistribution& keys,
+                                 const WorkloadScenario& scenario) const {
+        uint64_t id = keys.next(gen);
+        std::string sub = std::to_string(gen.below(16));
+        auto ttl = [&]() { return std::to_string(gen.between(scenario.ttl_min, scenario.ttl_max)); };
+        std::string list = "list:" + std::to_string(id);
+        std::string hash = "hash:" + std::to_string(id);
+        std::string set = "set:" + std::to_string(id);
+        
+        switch (op) {
+            case CommandMix::OP_GET: return "GET " + key_name(id);
+            case CommandMix::OP_SET: return "SET " + key_name(id) + " " + make_value(gen);
+            case CommandMix::OP_SETEX: return "SET " + key_name(id) + " " + make_value(gen) + " EX " + ttl();
+            case CommandMix::OP_DEL: return "DEL " + key_name(id);
+            case CommandMix::OP_EXISTS: return "EXISTS " + key_name(id);
+            case CommandMix::OP_EXPIRE: return "EXPIRE " + key_name(id) + " " + ttl();
+            case CommandMix::OP_TTL: return "TTL " + key_name(id);
+            case CommandMix::OP_LPUSH: return "LPUSH " + list + " " + make_value(gen);
+            case CommandMix::OP_RPUSH: return "RPUSH " + list + " " + make_value(gen);
+            case CommandMix::OP_LPOP: return "LPOP " + list;
+            case CommandMix::OP_RPOP: return "RPOP " + list;
+            case CommandMix::OP_LLEN: return "LLEN " + list;
+            case CommandMix::OP_LRANGE: return "LRANGE " + list + " 0 9";
+            case CommandMix::OP_HSET: return "HSET " + hash + " field:" + sub + " " + make_value(gen);
+            case CommandMix::OP_HGET: return "HGET " + hash + " field:" + sub;
+            case CommandMix::OP_HDEL: return "HDEL " + hash + " field:" + sub;
+            case CommandMix::OP_HGETALL: return "HGETALL " + hash;
+            case CommandMix::OP_SADD: return "SADD " + set + " member:" + sub;
+            case CommandMix::OP_SREM: return "SREM " + set + " member:" + sub;
+            case CommandMix::OP_SMEMBERS: return "SMEMBERS " + set;
+            case CommandMix::OP_SCARD: return "SCARD " + set;
+            case CommandMix::OP_PUBLISH: return "PUBLISH channel:" + std::to_string(id % 64) + " " + make_value(gen);
+            default: return "PING";
+        }
+    }
+    
+    void run_scenario(const WorkloadScenario& scenario) {
+        std::cout << "\n=== Scenario: " << scenario.name << " ===" << std::endl;
+        print_workload();
+        preload_keyspace();
+        
+        for (const auto& phase : scenario.phases) {
+            KeyDistribution phase_keys = key_distribution;
+            std::string key_spec = phase.key_dist.empty() ? key_distribution_spec : phase.key_dist;
+            if (!phase.key_dist.empty() && !phase_keys.configure(phase.key_dist, key_distribution.size())) {
+                std::cout << "Skipping phase " << phase.name << ": invalid key distribution " << phase.key_dist << std::endl;
+                continue;
+            }
+            
+            int connections = phase.connections > 0 ? phase.connections : scenario.connections;
+            std::cout << "\n--- Phase " << phase.name << ": " << phase.duration_seconds << " s, "
+                      << (phase.rate > 0 ? std::to_string(static_cast<long>(phase.rate)) + " ops/s open loop"
+                                         : std::string("closed loop"))
+                      << ", " << connections << " connections, keys " << key_spec << " ---" << std::endl;
+            std::cout << "Mix: " << phase.mix.describe() << std::endl;
+            
+            auto generator = [&](FastRandom& gen) {
+                return scenario_command(phase.mix.next(gen), gen, phase_keys, scenario);
+            };
+            
+            std::string result_name = scenario.name + "/" + phase.name;
+            RunSnapshot before = take_snapshot();
+            if (phase.rate > 0) {
+                OpenLoopResult result = run_open_loop(connections, phase.rate, phase.duration_seconds, generator);
+                print_open_loop_header();
+                print_open_loop_row(result);
+                add_open_loop_result(result_name, result, before);
+            } else {
+                EventLoopEngine::Options options;
+                options.connections = connections;
+                options.threads = scenario.threads;
+                options.pipeline = phase.pipeline > 0 ? phase.pipeline : scenario.pipeline;
+                options.think_time_us = phase.think_time_us >= 0 ? phase.think_time_us : scenario.think_time_us;
+                options.duration_seconds = phase.duration_seconds;
+                EventLoopEngine::Result result = EventLoopEngine(options, generator).run();
+                print_event_loop_result(result);
+                add_event_loop_result(result_name, result, before);
+            }
+        }
     }
     
     void run_connection_stress_test() {
@@ -335,6 +1757,175 @@ public:
         std::cout << "Successful connections: " << successful_connections.load() << std::endl;
         std::cout << "Connection success rate: " << (successful_connections.load() * 100.0 / max_connections) << "%" << std::endl;
         std::cout << "Total duration: " << duration.count() << " ms" << std::endl;
+        
+        results.push_back({"connection_stress", {
+            {"success_pct", successful_connections.load() * 100.0 / max_connections},
+            {"duration_ms", static_cast<double>(duration.count())}
+        }});
+    }
+    
+    // The same GET and SET traffic three ways: typed calls on an in-process
+    // engine, execute() on that engine (full command path and RESP reply, no
+    // socket), and one loopback TCP connection to the running server.
+    void run_embedded_comparison(int operations) {
+        std::cout << "\n=== Embedded vs Loopback Latency ===" << std::endl;
+        print_workload();
+        
+        RedisClone engine;
+        FastRandom gen(42);
+        for (uint64_t id = 0; id < key_distribution.size(); ++id) {
+            engine.set(key_name(id), make_value(gen));
+        }
+        
+        BenchmarkClient client;
+        bool loopback = client.connect_to_server();
+        if (loopback) {
+            preload_keyspace();
+        } else {
+            std::cout << "No server on localhost:6379, loopback rows skipped" << std::endl;
+        }
+        
+        std::cout << std::left << std::setw(24) << "mode" << std::right << std::setw(12) << "p50 us"
+                  << std::setw(12) << "p99 us" << std::setw(12) << "p99.9 us" << std::setw(14) << "ops/sec" << std::endl;
+        
+        auto measure = [&](const std::string& name, const std::function<void(const std::string&, const std::string&)>& op) {
+            HdrHistogram latency_ns;
+            auto run_start = std::chrono::steady_clock::now();
+            for (int i = 0; i < operations; ++i) {
+                std::string key = key_name(key_distribution.next(gen));
+                std::string value = make_value(gen);
+                auto start = std::chrono::steady_clock::now();
+                op(key, value);
+                latency_ns.record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start).count());
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - run_start).count();
+            
+            std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(2)
+                      << std::setw(12) << latency_ns.percentile(50.0) / 1e3 << std::setw(12) << latency_ns.percentile(99.0) / 1e3
+                      << std::setw(12) << latency_ns.percentile(99.9) / 1e3 << std::setw(14)
+                      << static_cast<long>(operations / seconds) << std::endl;
+            
+            std::vector<std::pair<std::string, double>> metrics = {{"operations", static_cast<double>(operations)}};
+            add_latency_metrics(metrics, latency_ns);
+            results.push_back({name, std::move(metrics)});
+        };
+        
+        std::string reply;
+        measure("embedded typed GET", [&](const std::string& key, const std::string&) { engine.get(key, reply); });
+        measure("embedded typed SET", [&](const std::string& key, const std::string& value) { engine.set(key, value); });
+        measure("embedded execute GET", [&](const std::string& key, const std::string&) { reply = engine.execute({"GET", key}); });
+        measure("embedded execute SET", [&](const std::string& key, const std::string& value) {
+            reply = engine.execute({"SET", key, value});
+        });
+        if (loopback) {
+            measure("loopback GET", [&](const std::string& key, const std::string&) { client.send_command_fast("GET " + key); });
+            measure("loopback SET", [&](const std::string& key, const std::string& value) {
+                client.send_command_fast("SET " + key + " " + value);
+            });
+        }
+    }
+    
+    // GET throughput against values of 1KB, 64KB and 1MB, each size on its
+    // own small set of keys so every reply is a full-size value.
+    void run_large_value_benchmark(int connections, int duration_seconds) {
+        std::cout << "\n=== Large Value GET Benchmark ===" << std::endl;
+        std::cout << "Connections: " << connections << ", Duration: " << duration_seconds << "s per size, Pipeline: "
+                  << pipeline_depth << std::endl;
+        
+        BenchmarkClient setup;
+        if (!setup.connect_to_server()) {
+            std::cout << "Error: Cannot connect to Redis clone server on localhost:6379" << std::endl;
+            return;
+        }
+        
+        const int kKeysPerSize = 16;
+        std::cout << std::left << std::setw(12) << "value size" << std::right << std::setw(14) << "ops/sec"
+                  << std::setw(14) << "MB/sec" << std::setw(10) << "errors" << std::endl;
+        
+        for (size_t size : {size_t(1) << 10, size_t(64) << 10, size_t(1) << 20}) {
+            std::string label = size >= (1 << 20) ? std::to_string(size >> 20) + "MB" : std::to_string(size >> 10) + "KB";
+            FastRandom gen(size);
+            for (int i = 0; i < kKeysPerSize; ++i) {
+                setup.send_command_fast("SET large:" + label + ":" + std::to_string(i) + " " + ValuePool::instance().make(size, gen));
+            }
+            
+            RunSnapshot before = take_snapshot();
+            auto start_time = std::chrono::steady_clock::now();
+            auto deadline = start_time + std::chrono::seconds(duration_seconds);
+            std::vector<std::thread> threads;
+            for (int t = 0; t < connections; ++t) {
+                threads.emplace_back([this, t, &label, deadline]() {
+                    BenchmarkClient client;
+                    if (!client.connect_to_server()) {
+                        failed_operations++;
+                        return;
+                    }
+                    
+                    int key = t;
+                    while (std::chrono::steady_clock::now() < deadline) {
+                        while (client.pending() < static_cast<size_t>(pipeline_depth)) {
+                            client.queue_command("GET large:" + label + ":" + std::to_string(key++ % kKeysPerSize));
+                        }
+                        flush_batch(client);
+                    }
+                });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+            
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+            double ops_per_second = successful_operations.load() / seconds;
+            double mb_per_second = ops_per_second * size / (1024.0 * 1024.0);
+            std::cout << std::left << std::setw(12) << label << std::right << std::setw(14) << static_cast<long>(ops_per_second)
+                      << std::fixed << std::setprecision(1) << std::setw(14) << mb_per_second
+                      << std::setw(10) << failed_operations.load() << std::endl;
+            
+            add_result("large_get/" + label, {
+                {"throughput_ops_per_sec", ops_per_second},
+                {"throughput_mb_per_sec", mb_per_second},
+                {"operations", static_cast<double>(total_operations.load())},
+                {"errors", static_cast<double>(failed_operations.load())},
+                {"duration_sec", seconds}
+            }, before, total_operations.load());
+            reset_counters();
+            
+            for (int i = 0; i < kKeysPerSize; ++i) {
+                setup.send_command_fast("DEL large:" + label + ":" + std::to_string(i));
+            }
+        }
+    }
+    
+    void run_hotkeys_report(int count) {
+        BenchmarkClient client;
+        if (!client.connect_to_server()) {
+            std::cout << "Error: Cannot connect to Redis clone server on localhost:6379" << std::endl;
+            return;
+        }
+        
+        std::string reply = client.query("HOTKEYS " + std::to_string(count));
+        if (reply.empty() || reply[0] == '-') {
+            std::cout << "HOTKEYS failed: " << reply << std::endl;
+            return;
+        }
+        
+        std::cout << "=== Hot Keys (estimated accesses) ===" << std::endl;
+        std::vector<std::string> lines;
+        size_t start = 0, end;
+        while ((end = reply.find("\r\n", start)) != std::string::npos) {
+            lines.push_back(reply.substr(start, end - start));
+            start = end + 2;
+        }
+        
+        int rank = 1;
+        for (size_t i = 1; i + 2 < lines.size(); i += 3) {
+            std::cout << std::setw(3) << rank++ << ". " << std::left << std::setw(40) << lines[i + 1]
+                      << std::right << lines[i + 2].substr(1) << std::endl;
+        }
+        if (rank == 1) {
+            std::cout << "No hot keys sampled yet" << std::endl;
+        }
     }
     
     void reset_counters() {
@@ -355,6 +1946,7 @@ public:
         }
         
         test_client.send_command_fast("FLUSHALL");
+        print_workload();
         
         run_set_benchmark(1, 10000, 16, 64);
         run_set_benchmark(4, 5000, 16, 64);
@@ -374,8 +1966,115 @@ public:
     }
 };
 
-int main() {
+int main(int argc, char* argv[]) {
     PerformanceBenchmark benchmark;
-    benchmark.run_all_benchmarks();
-    return 0;
+    
+    int connections = 4;
+    int duration_seconds = 5;
+    bool event_loop = false;
+    std::string workload_file;
+    std::string json_path, csv_path;
+    uint64_t keyspace = 1000;
+    std::string key_spec = "uniform";
+    std::string value_spec = "16";
+    bool preload = true;
+    EventLoopEngine::Options engine_options;
+    double sweep_from = 0, sweep_to = 0, sweep_step = 0;
+    int embedded_operations = 0;
+    bool large_values = false;
+    
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--compare" && i + 2 < argc) {
+            double threshold = i + 4 < argc && std::string(argv[i + 3]) == "--threshold" ? std::atof(argv[i + 4]) : 5.0;
+            int regressions = compare_results(argv[i + 1], argv[i + 2], threshold);
+            return regressions == 0 ? 0 : 1;
+        } else if (arg == "--json" && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (arg == "--csv" && i + 1 < argc) {
+            csv_path = argv[++i];
+        } else if (arg == "--embedded") {
+            embedded_operations = i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0])) ? std::atoi(argv[++i]) : 100000;
+        } else if (arg == "--large-values") {
+            large_values = true;
+        } else if (arg == "--hotkeys") {
+            benchmark.run_hotkeys_report(i + 1 < argc ? std::atoi(argv[i + 1]) : 20);
+            return 0;
+        } else if (arg == "-P" && i + 1 < argc) {
+            engine_options.pipeline = std::max(1, std::atoi(argv[i + 1]));
+            benchmark.set_pipeline_depth(std::atoi(argv[++i]));
+        } else if (arg == "--keyspace" && i + 1 < argc) {
+            keyspace = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--key-dist" && i + 1 < argc) {
+            key_spec = argv[++i];
+        } else if (arg == "--value-size" && i + 1 < argc) {
+            value_spec = argv[++i];
+        } else if (arg == "--no-preload") {
+            preload = false;
+        } else if (arg == "--workload" && i + 1 < argc) {
+            workload_file = argv[++i];
+        } else if (arg == "--event-loop") {
+            event_loop = true;
+        } else if (arg == "-t" && i + 1 < argc) {
+            engine_options.threads = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--think-us" && i + 1 < argc) {
+            engine_options.think_time_us = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "-c" && i + 1 < argc) {
+            connections = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "-d" && i + 1 < argc) {
+            duration_seconds = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--rate" && i + 1 < argc) {
+            sweep_from = sweep_to = std::atof(argv[++i]);
+        } else if (arg == "--sweep" && i + 3 < argc) {
+            sweep_from = std::atof(argv[++i]);
+            sweep_to = std::atof(argv[++i]);
+            sweep_step = std::atof(argv[++i]);
+        } else {
+            std::cout << "Usage: " << argv[0] << " [-P pipeline_depth] [--hotkeys [count]]\n"
+                      << "       " << argv[0] << " --rate <ops/s> | --sweep <from> <to> <step> [-c connections] [-d seconds]\n"
+                      << "       " << argv[0] << " --event-loop [-c connections] [-t threads] [-P depth] [--think-us n] [-d seconds]\n"
+                      << "Workload: [--keyspace n] [--key-dist uniform|zipf[:theta]|hotspot[:keys:ops]|latest[:theta]]\n"
+                      << "          [--value-size n|min-max] [--no-preload]\n"
+                      << "       " << argv[0] << " --workload <scenario file>\n"
+                      << "       " << argv[0] << " --embedded [operations]\n"
+                      << "       " << argv[0] << " --large-values [-c connections] [-P depth] [-d seconds]\n"
+                      << "Output:   [--json file] [--csv file]\n"
+                      << "       " << argv[0] << " --compare <base> <current> [--threshold pct]"
+                      << std::endl;
+            return 1;
+        }
+    }
+    
+    if (!workload_file.empty()) {
+        WorkloadScenario scenario;
+        std::string error;
+        if (!scenario.load(workload_file, error)) {
+            std::cout << "Invalid workload: " << error << std::endl;
+            return 1;
+        }
+        if (!benchmark.configure_workload(scenario.keyspace, scenario.key_dist, scenario.value_size, scenario.preload)) {
+            return 1;
+        }
+        benchmark.run_scenario(scenario);
+        return benchmark.write_results(json_path, csv_path) ? 0 : 1;
+    }
+    
+    if (!benchmark.configure_workload(keyspace, key_spec, value_spec, preload)) {
+        return 1;
+    }
+    
+    if (embedded_operations > 0) {
+        benchmark.run_embedded_comparison(embedded_operations);
+    } else if (large_values) {
+        benchmark.run_large_value_benchmark(connections, duration_seconds);
+    } else if (event_loop) {
+        engine_options.connections = connections;
+        engine_options.duration_seconds = duration_seconds;
+        benchmark.run_event_loop(engine_options);
+    } else if (sweep_from > 0) {
+        benchmark.run_rate_sweep(connections, sweep_from, sweep_to, sweep_step, duration_seconds);
+    } else {
+        benchmark.run_all_benchmarks();
+    }
+    return benchmark.write_results(json_path, csv_path) ? 0 : 1;
 }
\ No newline at end of file
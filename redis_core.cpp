@@ -0,0 +1,1875 @@
+#include "redis_core.h"
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+thread_local std::array<int64_t, LOCK_COUNT> ProfiledSharedMutex::shared_since_ns{};
+thread_local WorkerStats* RedisClone::tls_worker_stats = nullptr;
+thread_local std::string RedisClone::tls_client_addr;
+thread_local int RedisClone::tls_client_fd = -1;
+thread_local std::vector<ReplyRef>* RedisClone::tls_reply_refs = nullptr;
+thread_local bool RedisClone::tls_monitoring = false;
+
+void RedisClone::record_latency_event(const char* event, std::chrono::steady_clock::duration elapsed) {
+    uint64_t threshold = latency_threshold_ms.load(std::memory_order_relaxed);
+    if (threshold == 0) return;
+    
+    uint64_t latency_ms = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+    if (latency_ms >= threshold) {
+        latency_monitor.add_sample(event, latency_ms);
+    }
+}
+
+bool RedisClone::insert_key(const std::string& key, std::shared_ptr<RedisValue> value) {
+    uint64_t limit = maxkeys.load(std::memory_order_relaxed);
+    if (limit > 0 && data.size() >= limit && data.find(key) == data.end() &&
+        !evict_keys(data.size() - limit + 1)) {
+        return false;
+    }
+    
+    value->touch(lru_clock.load(std::memory_order_relaxed));
+    publish_key(key, value);
+    if (data.size() + 1 <= data.max_load_factor() * data.bucket_count()) {
+        data[key] = std::move(value);
+        return true;
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    data[key] = std::move(value);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    TRACE_PROBE2(rehash, data.bucket_count(),
+                 std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    record_latency_event("rehash", elapsed);
+    return true;
+}
+
+RedisClone::Keyspace::iterator RedisClone::erase_key(Keyspace::iterator it, bool lazy) {
+    key_index.remove(it->first);
+    if (lazy && free_effort(*it->second) > kLazyFreeThreshold) {
+        std::lock_guard<std::mutex> lock(lazyfree_mutex);
+        lazyfree_values.push_back(std::move(it->second));
+        lazyfree_pending_objects.fetch_add(1, std::memory_order_relaxed);
+        lazyfree_cv.notify_one();
+    }
+    return data.erase(it);
+}
+
+// Roughly the number of allocations destroying the value takes.
+size_t RedisClone::free_effort(const RedisValue& value) {
+    switch (value.type) {
+        case RedisValue::LIST: return value.list_val.size();
+        case RedisValue::HASH: return value.hash_val.size();
+        case RedisValue::SET: return value.set_val.size();
+        default: return 1;
+    }
+}
+
+void RedisClone::wake_lazyfree() {
+    std::lock_guard<std::mutex> lock(lazyfree_mutex);
+    lazyfree_reclaim = true;
+    lazyfree_cv.notify_one();
+}
+
+void RedisClone::lazyfree_loop() {
+#ifdef __linux__
+    // Background work: a freshly woken free thread should not preempt the
+    // client thread that just queued the value.
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 10);
+#endif
+    std::unique_lock<std::mutex> lock(lazyfree_mutex);
+    while (running) {
+        lazyfree_cv.wait_for(lock, std::chrono::milliseconds(100), [&]() {
+            return !running || lazyfree_reclaim || !lazyfree_values.empty() || !lazyfree_keyspaces.empty();
+        });
+        std::vector<std::shared_ptr<RedisValue>> values;
+        std::vector<std::unique_ptr<Keyspace>> keyspaces;
+        values.swap(lazyfree_values);
+        keyspaces.swap(lazyfree_keyspaces);
+        lazyfree_reclaim = false;
+        lock.unlock();
+        
+        uint64_t freed = values.size();
+        for (const auto& keyspace : keyspaces) {
+            freed += keyspace->size();
+        }
+        values.clear();
+        keyspaces.clear();
+        if (freed > 0) {
+            lazyfree_pending_objects.fetch_sub(freed, std::memory_order_relaxed);
+            lazyfreed_objects_total.fetch_add(freed, std::memory_order_relaxed);
+        }
+        read_epochs.reclaim();
+        reap_zerocopy_orphans();
+        
+        lock.lock();
+    }
+}
+
+// Called for every new value and whenever a key's type or expiry changes.
+void RedisClone::publish_key(const std::string& key, const std::shared_ptr<RedisValue>& value) {
+    auto* entry = new ReadIndex::Entry();
+    entry->key = key;
+    entry->type = value->type;
+    entry->has_expiry = value->has_expiry;
+    entry->expiry = value->expiry;
+    if (value->type == RedisValue::STRING) {
+        entry->str = value->str_val;
+    }
+    key_index.publish(entry, [&](const ReadIndex::Entry& previous) {
+        entry->last_access.store(previous.last_access.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    });
+}
+
+// Approximated LRU in the style of Redis: sample a few keys from random
+// buckets and drop the least recently used (or, for allkeys-random, the first
+// one). Already-expired samples are taken first. Requires the exclusive lock.
+bool RedisClone::evict_keys(uint64_t count) {
+    int policy = eviction_policy.load(std::memory_order_relaxed);
+    if (policy == EVICT_NONE) return false;
+    
+    thread_local uint64_t seed = 0x9E3779B97F4A7C15ULL ^ reinterpret_cast<uintptr_t>(&seed);
+    auto next_random = [&]() {
+        seed ^= seed >> 12;
+        seed ^= seed << 25;
+        seed ^= seed >> 27;
+        return seed * 0x2545F4914F6CDD1DULL;
+    };
+    
+    auto start = std::chrono::steady_clock::now();
+    uint64_t evicted = 0;
+    while (evicted < count && !data.empty()) {
+        size_t buckets = data.bucket_count();
+        const std::string* victim = nullptr;
+        uint32_t victim_access = 0;
+        int samples = policy == EVICT_ALLKEYS_RANDOM ? 1 : kEvictionSamples;
+        
+        for (int i = 0; i < samples; ++i) {
+            size_t bucket = next_random() % buckets;
+            while (data.bucket_size(bucket) == 0) {
+                bucket = (bucket + 1) % buckets;
+            }
+            auto candidate = data.begin(bucket);
+            uint32_t access = candidate->second->last_access.load(std::memory_order_relaxed);
+            const ReadIndex::Entry* entry = key_index.find(candidate->first);
+            if (entry) access = std::max(access, entry->last_access.load(std::memory_order_relaxed));
+            if (candidate->second->is_expired()) {
+                victim = &candidate->first;
+                break;
+            }
+            if (!victim || access < victim_access) {
+                victim = &candidate->first;
+                victim_access = access;
+            }
+        }
+        
+        erase_key(data.find(*victim), lazyfree_eviction.load(std::memory_order_relaxed));
+        evicted++;
+    }
+    
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    evicted_keys_total.fetch_add(evicted, std::memory_order_relaxed);
+    TRACE_PROBE2(evict, evicted, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    record_latency_event("eviction", elapsed);
+    return true;
+}
+
+void RedisClone::cleanup_expired_keys() {
+    uint64_t seconds = 0;
+    while (running) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        
+        uint32_t decay_seconds = hotkeys_decay_seconds.load(std::memory_order_relaxed);
+        if (decay_seconds > 0 && ++seconds % decay_seconds == 0) {
+            hotkeys_decay_epoch.fetch_add(1, std::memory_order_relaxed);
+        }
+        lru_clock.fetch_add(1, std::memory_order_relaxed);
+        
+        expire_sweep();
+    }
+}
+
+uint64_t RedisClone::expire_sweep() {
+    TRACE_PROBE(expire__sweep__start);
+    std::unique_lock<ProfiledSharedMutex> lock(data_mutex);
+    auto start = std::chrono::steady_clock::now();
+    uint64_t expired = 0, expires = 0;
+    bool lazy = lazyfree_expire.load(std::memory_order_relaxed);
+    
+    auto it = data.begin();
+    while (it != data.end()) {
+        if (it->second->is_expired()) {
+            it = erase_key(it, lazy);
+            expired++;
+        } else {
+            if (it->second->has_expiry) expires++;
+            ++it;
+        }
+    }
+    
+    uint64_t remaining = data.size();
+    keyspace_keys.store(remaining, std::memory_order_relaxed);
+    lock.unlock();
+    
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    keyspace_expires.store(expires, std::memory_order_relaxed);
+    expired_keys_total.fetch_add(expired, std::memory_order_relaxed);
+    expire_cycles_total.fetch_add(1, std::memory_order_relaxed);
+    uint64_t elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    expire_cycle_last_ns.store(elapsed_ns, std::memory_order_relaxed);
+    TRACE_PROBE3(expire__sweep__end, remaining, expired, elapsed_ns);
+    record_latency_event("expire-cycle", elapsed);
+    return expired;
+}
+
+void RedisClone::process_command(const std::vector<std::string>& tokens, std::string& out) {
+    if (tokens.empty()) return append_error(out, "ERR unknown command");
+    
+    std::string cmd = tokens[0];
+    std::transform(cmd.begin(), cmd.end(), cmd.begin(), ::toupper);
+    
+    CommandId id = lookup_command(cmd);
+    if (id == CMD_UNKNOWN) {
+        return append_error(out, "ERR unknown command '" + cmd + "'");
+    }
+    
+    WorkerStats* stats = current_worker_stats();
+    if (monitor_active.load(std::memory_order_relaxed)) {
+        feed_monitor(stats, tokens);
+    }
+    
+    TRACE_PROBE3(command__start, kCommandNames[id], tokens.size(),
+                 tokens.size() > 1 ? tokens[1].c_str() : "");
+    tls_current_command = id;
+    if (tls_worker_stats) {
+        tls_worker_stats->client.current_command.store(id, std::memory_order_relaxed);
+    }
+    size_t reply_start = out.size();
+    auto start = std::chrono::steady_clock::now();
+    dispatch_command(id, tokens, out);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    tls_current_command = CMD_COUNT;
+    
+    uint64_t elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    TRACE_PROBE3(command__end, kCommandNames[id], elapsed_ns, out.size() - reply_start);
+    stats->record_command(id, elapsed_ns);
+    
+    long long slower_than = slowlog_slower_than.load(std::memory_order_relaxed);
+    if (slower_than >= 0 && elapsed_ns / 1000 >= static_cast<uint64_t>(slower_than)) {
+        record_slowlog(stats, tokens, elapsed_ns / 1000);
+    }
+    record_latency_event("command", elapsed);
+    
+    if (id <= CMD_SCARD && tokens.size() > 1) {
+        sample_hot_key(stats, tokens[1]);
+    }
+}
+
+// Keyspace commands append their reply to out directly; the rest build a
+// string, which is fine off the hot path.
+void RedisClone::dispatch_command(CommandId id, const std::vector<std::string>& tokens, std::string& out) {
+    switch (id) {
+        case CMD_SET: return handle_set(tokens, out);
+        case CMD_GET: return handle_get(tokens, out);
+        case CMD_DEL: return handle_del(tokens, out, false);
+        case CMD_UNLINK: return handle_del(tokens, out, true);
+        case CMD_EXISTS: return handle_exists(tokens, out);
+        case CMD_EXPIRE: return handle_expire(tokens, out);
+        case CMD_TTL: return handle_ttl(tokens, out);
+        case CMD_LPUSH: return handle_lpush(tokens, out);
+        case CMD_RPUSH: return handle_rpush(tokens, out);
+        case CMD_LPOP: return handle_lpop(tokens, out);
+        case CMD_RPOP: return handle_rpop(tokens, out);
+        case CMD_LLEN: return handle_llen(tokens, out);
+        case CMD_LRANGE: return handle_lrange(tokens, out);
+        case CMD_HSET: return handle_hset(tokens, out);
+        case CMD_HGET: return handle_hget(tokens, out);
+        case CMD_HDEL: return handle_hdel(tokens, out);
+        case CMD_HGETALL: return handle_hgetall(tokens, out);
+        case CMD_SADD: return handle_sadd(tokens, out);
+        case CMD_SREM: return handle_srem(tokens, out);
+        case CMD_SMEMBERS: return handle_smembers(tokens, out);
+        case CMD_SCARD: return handle_scard(tokens, out);
+        case CMD_PUBLISH: out += handle_publish(tokens); return;
+        case CMD_PING: return append_simple_string(out, "PONG");
+        case CMD_INFO: out += handle_info(tokens); return;
+        case CMD_FLUSHALL:
+        case CMD_FLUSHDB: out += handle_flushall(tokens); return;
+        case CMD_CONFIG: out += handle_config(tokens); return;
+        case CMD_SLOWLOG: out += handle_slowlog(tokens); return;
+        case CMD_LATENCY: out += handle_latency(tokens); return;
+        case CMD_HOTKEYS: out += handle_hotkeys(tokens); return;
+        case CMD_BIGKEYS: out += handle_bigkeys(tokens); return;
+        case CMD_MONITOR: out += handle_monitor(tokens); return;
+        case CMD_CLIENT: out += handle_client_command(tokens); return;
+        default: break;
+    }
+    append_error(out, "ERR unknown command");
+}
+
+void RedisClone::sample_hot_key(WorkerStats* stats, const std::string& key) {
+    uint32_t rate = hotkeys_sample_rate.load(std::memory_order_relaxed);
+    if (rate == 0 || stats == &shared_worker_stats) return;
+    
+    if (stats->hotkey_countdown > 1) {
+        stats->hotkey_countdown--;
+        return;
+    }
+    stats->hotkey_countdown = rate;
+    stats->hotkeys.record(key, hotkeys_decay_epoch.load(std::memory_order_relaxed));
+}
+
+WorkerStats* RedisClone::current_worker_stats() {
+    return tls_worker_stats ? tls_worker_stats : &shared_worker_stats;
+}
+
+void RedisClone::handle_set(const std::vector<std::string>& tokens, std::string& out) {
+    if (tokens.size() < 3) return append_error(out, "ERR wrong number of arguments for 'set' command");
+    
+    auto value = std::make_shared<RedisValue>(RedisValue::STRING);
+    value->assign_string(tokens[2]);
+    
+    if (tokens.size() >= 5 && tokens[3] == "EX") {
+        try {
+            int seconds = std::stoi(tokens[4]);
+            value->set_expiry(seconds);
+        } catch (...) {
+            return append_error(out, "ERR invalid expire time");
+        }
+    }
+    
+    std::unique_lock<ProfiledSharedMutex> lock(data_mutex);
+    if (!insert_key(tokens[1], value)) return append_error(out, kOomError);
+    return append_simple_string(out, "OK");
+}
+
+void RedisClone::handle_get(const std::vector<std::string>& tokens, std::string& out) {
+    if (tokens.size() < 2) return append_error(out, "ERR wrong number of arguments for 'get' command");
+    
+    ReadSection section(*this);
+    const ReadIndex::Entry* entry = key_index.find(tokens[1]);
+    if (!entry || entry->is_expired()) {
+        return append_null_bulk(out);
+    }
+    
+    if (entry->type != RedisValue::STRING) {
+        return append_error(out, "WRONGTYPE Operation against a key holding the wrong kind of value");
+    }
+    
+    entry->touch(lru_clock.load(std::memory_order_relaxed));
+    
+    // On a connection a large value is referenced rather than copied; the
+    // send path writes it out from the buffer itself.
+    if (tls_reply_refs && entry->str->size() >= kReplySpliceMin) {
+        append_prefixed_decimal(out, '$', static_cast<long long>(entry->str->size()));
+        tls_reply_refs->push_back({out.size(), entry->str});
+        out.append("\r\n", 2);
+        return;
+    }
+    return append_bulk_string(out, *entry->str);
+}
+
+// UNLINK is DEL with large values freed on lazyfree_thread;
+// lazyfree-lazy-user-del makes DEL behave the same way.
+void RedisClone::handle_del(const std::vector<std::string>& tokens, std::string& out, bool unlink) {
+    if (tokens.size() < 2) {
+        return append_error(out, unlink ? "ERR wrong number of arguments for 'unlink' command"
+                                        : "ERR wrong number of arguments for 'del' command");
+    }
+    bool lazy = unlink || lazyfree_user_del.load(std::memory_order_relaxed);
+    
+    std::unique_lock<ProfiledSharedMutex> lock(data_mutex);
+    int deleted = 0;
+    for (size_t i = 1; i < tokens.size(); ++i) {
+        auto it = data.find(tokens[i]);
+        if (it != data.end()) {
+            erase_key(it, lazy);
+            deleted++;
+        }
+    }
+    return append_integer(out, deleted);
+}
+
+void RedisClone::handle_exists(const std::vector<std::string>& tokens, std::string& out) {
+    if (tokens.size() < 2) return append_error(out, "ERR wrong number of arguments for 'exists' command");
+    
+    ReadSection section(*this);
+    int exists = 0;
+    for (size_t i = 1; i < tokens.size(); ++i) {
+        const ReadIndex::Entry* entry = key_index.find(tokens[i]);
+        if (entry && !entry->is_expired()) {
+            exists++;
+        }
+    }
+    return append_integer(out, exists);
+}
+
+void RedisClone::handle_expire(const std::vector<std::string>& tokens, std::string& out) {
+    if (tokens.size() < 3) return append_error(out, "ERR wrong number of arguments for 'expire' command");
+    
+    std::unique_lock<ProfiledSharedMutex> lock(data_mutex);
+    auto it = data.find(tokens[1]);
+    if (it == data.end() || it->second->is_expired()) {
+        return append_integer(out, 0);
+    }
+    
+    try {
+        int seconds = std::stoi(tokens[2]);
+        it->second->set_expiry(seconds);
+        publish_key(it->first, it->second);
+        return append_integer(out, 1);
+    } catch (...) {
+        return append_error(out, "ERR invalid expire time");
+    }
+}
+
+void RedisClone::handle_ttl(const std::vector<std::string>& tokens, std::string& out) {
+    if (tokens.size() < 2) return append_error(out, "ERR wrong number of arguments for 'ttl' command");
+    
+    ReadSection section(*this);
+    const ReadIndex::Entry* entry = key_index.find(tokens[1]);
+    if (!entry) {
+        return append_integer(out, -2);
+    }
+    
+    if (entry->is_expired()) {
+        return append_integer(out, -2);
+    }
+    
+    if (!entry->has_expiry) {
+        return append_integer(out, -1);
+    }
+    
+    auto now = std::chrono::steady_clock::now();
+    auto remaining = std::chrono::duration_cast<std::chrono::seconds>(entry->expiry - now);
+    return append_integer(out, remaining.count());
+}
+
+void RedisClone::handle_lpush(const std::vector<std::string>& tokens, std::string& out) {
+    if (tokens.size() < 3) return append_error(out, "ERR wrong number of arguments for 'lpush' command");
+    
+    std::unique_lock<ProfiledSharedMutex> lock(data_mutex);
+    auto it = data.find(tokens[1]);
+    std::shared_ptr<RedisValue> value;
+    
+    if (it == data.end() || it->second->is_expired()) {
+        value = std::make_shared<RedisValue>(RedisValue::LIST);
+        if (!insert_key(tokens[1], value)) return append_error(out, kOomError);
+    } else {
+        value = it->second;
+        value->touch(lru_clock.load(std::memory_order_relaxed));
+        if (value->type != RedisValue::LIST) {
+            return append_error(out, "WRONGTYPE Operation against a key holding the wrong kind of value");
+        }
+    }
+    
+    for (size_t i = 2; i < tokens.size(); ++i) {
+        value->list_val.push_front(tokens[i]);
+    }
+    
+    return append_integer(out, value->list_val.size());
+}
+
+void RedisClone::handle_rpush(const std::vector<std::string>& tokens, std::string& out) {
+    if (tokens.size() < 3) return append_error(out, "ERR wrong number of arguments for 'rpush' command");
+    
+    std::unique_lock<ProfiledSharedMutex> lock(data_mutex);
+    auto it = data.find(tokens[1]);
+    std::shared_ptr<RedisValue> value;
+    
+    if (it == data.end() || it->second->is_expired()) {
+        value = std::make_shared<RedisValue>(RedisValue::LIST);
+        if (!insert_key(tokens[1], value)) return append_error(out, kOomError);
+    } else {
+        value = it->second;
+        value->touch(lru_clock.load(std::memory_order_relaxed));
+        if (value->type != RedisValue::LIST) {
+            return append_error(out, "WRONGTYPE Operation against a key holding the wrong kind of value");
+        }
+    }
+    
+    for (size_t i = 2; i < tokens.size(); ++i) {
+        value->list_val.push_back(tokens[i]);
+    }
+    
+    return append_integer(out, value->list_val.size());
+}
+
+void RedisClone::handle_lpop(const std::vector<std::string>& tokens, std::string& out) {
+    if (tokens.size() < 2) return append_error(out, "ERR wrong number of arguments for 'lpop' command");
+    
+    std::unique_lock<ProfiledSharedMutex> lock(data_mutex);
+    auto it = data.find(tokens[1]);
+    if (it == data.end() || it->second->is_expired() || it->second->type != RedisValue::LIST) {
+        return append_null_bulk(out);
+    }
+    
+    if (it->second->list_val.empty()) {
+        return append_null_bulk(out);
+    }
+    
+    std::string result = it->second->list_val.front();
+    it->second->list_val.pop_front();
+    return append_bulk_string(out, result);
+}
+
+void RedisClone::handle_rpop(const std::vector<std::string>& tokens, std::string& out) {
+    if (tokens.size() < 2) return append_error(out, "ERR wrong number of arguments for 'rpop' command");
+    
+    std::unique_lock<ProfiledSharedMutex> lock(data_mutex);
+    auto it = data.find(tokens[1]);
+    if (it == data.end() || it->second->is_expired() || it->second->type != RedisValue::LIST) {
+        return append_null_bulk(out);
+    }
+    
+    if (it->second->list_val.empty()) {
+        return append_null_bulk(out);
+    }
+    
+    std::string result = it->second->list_val.back();
+    it->second->list_val.pop_back();
+    return append_bulk_string(out, result);
+}
+
+void RedisClone::handle_llen(const std::vector<std::string>& tokens, std::string& out) {
+    if (tokens.size() < 2) return append_error(out, "ERR wrong number of arguments for 'llen' command");
+    
+    std::shared_lock<ProfiledSharedMutex> lock(data_mutex);
+    auto it = data.find(tokens[1]);
+    if (it == data.end() || it->second->is_expired()) {
+        return append_integer(out, 0);
+    }
+    
+    if (it->second->type != RedisValue::LIST) {
+        return append_error(out, "WRONGTYPE Operation against a key holding the wrong kind of value");
+    }
+    
+    return append_integer(out, it->second->list_val.size());
+}
+
+void RedisClone::handle_lrange(const std::vector<std::string>& tokens, std::string& out) {
+    if (tokens.size() < 4) return append_error(out, "ERR wrong number of arguments for 'lrange' command");
+    
+    std::shared_lock<ProfiledSharedMutex> lock(data_mutex);
+    auto it = data.find(tokens[1]);
+    if (it == data.end() || it->second->is_expired() || it->second->type != RedisValue::LIST) {
+        return append_array_header(out, 0);
+    }
+    
+    try {
+        int start = std::stoi(tokens[2]);
+        int stop = std::stoi(tokens[3]);
+        it->second->touch(lru_clock.load(std::memory_order_relaxed));
+        const auto& list = it->second->list_val;
+        int size = list.size();
+        
+        if (start < 0) start += size;
+        if (stop < 0) stop += size;
+        
+        if (start < 0) start = 0;
+        if (stop >= size) stop = size - 1;
+        
+        if (start > stop) return append_array_header(out, 0);
+        
+        append_array_header(out, stop - start + 1);
+        auto it_cur = list.begin();
+        std::advance(it_cur, start);
+        for (int i = start; i <= stop; ++i, ++it_cur) {
+            append_bulk_string(out, *it_cur);
+        }
+    } catch (...) {
+        return append_error(out, "ERR invalid range");
+    }
+}
+
+void RedisClone::handle_hset(const std::vector<std::string>& tokens, std::string& out) {
+    if (tokens.size() < 4 || tokens.size() % 2 != 0) {
+        return append_error(out, "ERR wrong number of arguments for 'hset' command");
+    }
+    
+    std::unique_lock<ProfiledSharedMutex> lock(data_mutex);
+    auto it = data.find(tokens[1]);
+    std::shared_ptr<RedisValue> value;
+    
+    if (it == data.end() || it->second->is_expired()) {
+        value = std::make_shared<RedisValue>(RedisValue::HASH);
+        if (!insert_key(tokens[1], value)) return append_error(out, kOomError);
+    } else {
+        value = it->second;
+        value->touch(lru_clock.load(std::memory_order_relaxed));
+        if (value->type != RedisValue::HASH) {
+            return append_error(out, "WRONGTYPE Operation against a key holding the wrong kind of value");
+        }
+    }
+    
+    int added = 0;
+    for (size_t i = 2; i < tokens.size(); i += 2) {
+        if (value->hash_val.find(tokens[i]) == value->hash_val.end()) {
+            added++;
+        }
+        value->hash_val[tokens[i]] = tokens[i + 1];
+    }
+    
+    return append_integer(out, added);
+}
+
+void RedisClone::handle_hget(const std::vector<std::string>& tokens, std::string& out) {
+    if (tokens.size() < 3) return append_error(out, "ERR wrong number of arguments for 'hget' command");
+    
+    std::shared_lock<ProfiledSharedMutex> lock(data_mutex);
+    auto it = data.find(tokens[1]);
+    if (it == data.end() || it->second->is_expired() || it->second->type != RedisValue::HASH) {
+        return append_null_bulk(out);
+    }
+    
+    it->second->touch(lru_clock.load(std::memory_order_relaxed));
+    auto hash_it = it->second->hash_val.find(tokens[2]);
+    if (hash_it == it->second->hash_val.end()) {
+        return append_null_bulk(out);
+    }
+    
+    return append_bulk_string(out, hash_it->second);
+}
+
+void RedisClone::handle_hdel(const std::vector<std::string>& tokens, std::string& out) {
+    if (tokens.size() < 3) return append_error(out, "ERR wrong number of arguments for 'hdel' command");
+    
+    std::unique_lock<ProfiledSharedMutex> lock(data_mutex);
+    auto it = data.find(tokens[1]);
+    if (it == data.end() || it->second->is_expired() || it->second->type != RedisValue::HASH) {
+        return append_integer(out, 0);
+    }
+    
+    int deleted = 0;
+    for (size_t i = 2; i < tokens.size(); ++i) {
+        if (it->second->hash_val.erase(tokens[i]) > 0) {
+            deleted++;
+        }
+    }
+    
+    return append_integer(out, deleted);
+}
+
+void RedisClone::handle_hgetall(const std::vector<std::string>& tokens, std::string& out) {
+    if (tokens.size() < 2) return append_error(out, "ERR wrong number of arguments for 'hgetall' command");
+    
+    std::shared_lock<ProfiledSharedMutex> lock(data_mutex);
+    auto it = data.find(tokens[1]);
+    if (it == data.end() || it->second->is_expired() || it->second->type != RedisValue::HASH) {
+        return append_array_header(out, 0);
+    }
+    
+    it->second->touch(lru_clock.load(std::memory_order_relaxed));
+    append_array_header(out, it->second->hash_val.size() * 2);
+    for (const auto& pair : it->second->hash_val) {
+        append_bulk_string(out, pair.first);
+        append_bulk_string(out, pair.second);
+    }
+}
+
+void RedisClone::handle_sadd(const std::vector<std::string>& tokens, std::string& out) {
+    if (tokens.size() < 3) return append_error(out, "ERR wrong number of arguments for 'sadd' command");
+    
+    std::unique_lock<ProfiledSharedMutex> lock(data_mutex);
+    auto it = data.find(tokens[1]);
+    std::shared_ptr<RedisValue> value;
+    
+    if (it == data.end() || it->second->is_expired()) {
+        value = std::make_shared<RedisValue>(RedisValue::SET);
+        if (!insert_key(tokens[1], value)) return append_error(out, kOomError);
+    } else {
+        value = it->second;
+        value->touch(lru_clock.load(std::memory_order_relaxed));
+        if (value->type != RedisValue::SET) {
+            return append_error(out, "WRONGTYPE Operation against a key holding the wrong kind of value");
+        }
+    }
+    
+    int added = 0;
+    for (size_t i = 2; i < tokens.size(); ++i) {
+        if (value->set_val.insert(tokens[i]).second) {
+            added++;
+        }
+    }
+    
+    return append_integer(out, added);
+}
+
+void RedisClone::handle_srem(const std::vector<std::string>& tokens, std::string& out) {
+    if (tokens.size() < 3) return append_error(out, "ERR wrong number of arguments for 'srem' command");
+    
+    std::unique_lock<ProfiledSharedMutex> lock(data_mutex);
+    auto it = data.find(tokens[1]);
+    if (it == data.end() || it->second->is_expired() || it->second->type != RedisValue::SET) {
+        return append_integer(out, 0);
+    }
+    
+    int removed = 0;
+    for (size_t i = 2; i < tokens.size(); ++i) {
+        if (it->second->set_val.erase(tokens[i]) > 0) {
+            removed++;
+        }
+    }
+    
+    return append_integer(out, removed);
+}
+
+void RedisClone::handle_smembers(const std::vector<std::string>& tokens, std::string& out) {
+    if (tokens.size() < 2) return append_error(out, "ERR wrong number of arguments for 'smembers' command");
+    
+    std::shared_lock<ProfiledSharedMutex> lock(data_mutex);
+    auto it = data.find(tokens[1]);
+    if (it == data.end() || it->second->is_expired() || it->second->type != RedisValue::SET) {
+        return append_array_header(out, 0);
+    }
+    
+    it->second->touch(lru_clock.load(std::memory_order_relaxed));
+    append_array_header(out, it->second->set_val.size());
+    for (const auto& member : it->second->set_val) {
+        append_bulk_string(out, member);
+    }
+}
+
+void RedisClone::handle_scard(const std::vector<std::string>& tokens, std::string& out) {
+    if (tokens.size() < 2) return append_error(out, "ERR wrong number of arguments for 'scard' command");
+    
+    std::shared_lock<ProfiledSharedMutex> lock(data_mutex);
+    auto it = data.find(tokens[1]);
+    if (it == data.end() || it->second->is_expired() || it->second->type != RedisValue::SET) {
+        return append_integer(out, 0);
+    }
+    
+    return append_integer(out, it->second->set_val.size());
+}
+
+std::string RedisClone::handle_publish(const std::vector<std::string>& tokens) {
+    if (tokens.size() < 3) return encode_error("ERR wrong number of arguments for 'publish' command");
+    
+    int count = pubsub_manager.publish(tokens[1], tokens[2]);
+    return encode_integer(count);
+}
+
+std::string RedisClone::handle_info(const std::vector<std::string>& tokens) {
+    std::string section = tokens.size() > 1 ? tokens[1] : "default";
+    std::transform(section.begin(), section.end(), section.begin(), ::tolower);
+    bool everything = section == "all" || section == "everything";
+    bool defaults = everything || section == "default";
+    
+    std::string info;
+    if (defaults || section == "server") {
+        info += "# Server\r\nredis_version:7.0.0-compatible\r\n";
+    }
+    if (defaults || section == "clients") {
+        info += "# Clients\r\nconnected_clients:" + std::to_string(connection_pool.get_active_count()) + "\r\n";
+        {
+            std::lock_guard<std::mutex> lock(monitor_mutex);
+            info += "monitor_clients:" + std::to_string(monitor_clients.size()) + "\r\n";
+        }
+        info += "monitor_dropped_records:" + std::to_string(monitor_dropped.load()) + "\r\n";
+    }
+    if (defaults || section == "memory" || section == "keyspace") {
+        std::shared_lock<ProfiledSharedMutex> lock(data_mutex);
+        if (defaults || section == "memory") {
+            info += "# Memory\r\nused_memory:" + std::to_string(data.size() * sizeof(RedisValue)) + "\r\n";
+            info += "used_memory_rss:" + std::to_string(read_rss_bytes()) + "\r\n";
+        }
+        if (defaults || section == "keyspace") {
+            info += "# Keyspace\r\ndb0:keys=" + std::to_string(data.size()) + "\r\n";
+        }
+    }
+    if (defaults || section == "stats") {
+        info += info_stats();
+    }
+    if (defaults || section == "cpu") {
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        auto seconds = [](const timeval& tv) { return format_fixed(tv.tv_sec + tv.tv_usec / 1e6, 6); };
+        info += "# CPU\r\nused_cpu_sys:" + seconds(usage.ru_stime) + "\r\n";
+        info += "used_cpu_user:" + seconds(usage.ru_utime) + "\r\n";
+    }
+    if (everything || section == "commandstats") {
+        info += info_commandstats();
+    }
+    if (everything || section == "lockstats") {
+        info += info_lockstats();
+    }
+    if (everything || section == "keyspace_analysis") {
+        info += info_keyspace_analysis();
+    }
+    if (everything || section == "latencystats") {
+        info += info_latencystats();
+    }
+    return encode_bulk_string(info);
+}
+
+std::array<LatencyHistogram::Counts, CMD_COUNT> RedisClone::collect_command_histograms(
+        std::array<uint64_t, CMD_COUNT>& calls, std::array<uint64_t, CMD_COUNT>& total_ns) {
+    std::array<LatencyHistogram::Counts, CMD_COUNT> histograms{};
+    calls.fill(0);
+    total_ns.fill(0);
+    
+    auto collect = [&](const WorkerStats& stats) {
+        for (int i = 0; i < CMD_COUNT; ++i) {
+            const CommandCounters* counters = stats.command(static_cast<CommandId>(i));
+            if (!counters) continue;
+            calls[i] += counters->calls.load(std::memory_order_relaxed);
+            total_ns[i] += counters->total_ns.load(std::memory_order_relaxed);
+            counters->latency_ns.add_to(histograms[i]);
+        }
+    };
+    worker_stats.for_each(collect);
+    collect(shared_worker_stats);
+    return histograms;
+}
+
+std::string RedisClone::info_stats() {
+    uint64_t commands = 0, input_bytes = 0, output_bytes = 0;
+    for_each_worker_stats([&](WorkerStats& stats) {
+        for (int i = 0; i < CMD_COUNT; ++i) {
+            const CommandCounters* counters = stats.command(static_cast<CommandId>(i));
+            if (counters) commands += counters->calls.load(std::memory_order_relaxed);
+        }
+        input_bytes += stats.net_input_bytes.load(std::memory_order_relaxed);
+        output_bytes += stats.net_output_bytes.load(std::memory_order_relaxed);
+    });
+    
+    return "# Stats\r\ntotal_connections_received:" + std::to_string(total_connections_received.load()) + "\r\n" +
+           "total_commands_processed:" + std::to_string(commands) + "\r\n" +
+           "total_net_input_bytes:" + std::to_string(input_bytes) + "\r\n" +
+           "total_net_output_bytes:" + std::to_string(output_bytes) + "\r\n" +
+           "expired_keys:" + std::to_string(expired_keys_total.load()) + "\r\n" +
+           "evicted_keys:" + std::to_string(evicted_keys_total.load()) + "\r\n" +
+           "lazyfree_pending_objects:" + std::to_string(lazyfree_pending_objects.load()) + "\r\n" +
+           "lazyfreed_objects:" + std::to_string(lazyfreed_objects_total.load()) + "\r\n";
+}
+
+std::string RedisClone::info_lockstats() {
+    struct Totals {
+        uint64_t acquisitions = 0, contended = 0, wait_ns = 0, hold_ns = 0;
+        LatencyHistogram::Counts wait_hist{}, hold_hist{};
+        std::array<uint64_t, LockCounters::kCallers> caller_acquisitions{}, caller_wait_ns{}, caller_hold_ns{};
+    };
+    std::vector<Totals> totals(LOCK_COUNT);
+    
+    for_each_worker_stats([&](WorkerStats& stats) {
+        for (int lock = 0; lock < LOCK_COUNT; ++lock) {
+            const LockCounters* counters = stats.locks.find(static_cast<LockId>(lock));
+            if (!counters) continue;
+            Totals& total = totals[lock];
+            total.acquisitions += counters->acquisitions.load(std::memory_order_relaxed);
+            total.contended += counters->contended.load(std::memory_order_relaxed);
+            total.wait_ns += counters->wait_ns.load(std::memory_order_relaxed);
+            total.hold_ns += counters->hold_ns.load(std::memory_order_relaxed);
+            counters->wait_hist.add_to(total.wait_hist);
+            counters->hold_hist.add_to(total.hold_hist);
+            for (int caller = 0; caller < LockCounters::kCallers; ++caller) {
+                total.caller_acquisitions[caller] += counters->caller_acquisitions[caller].load(std::memory_order_relaxed);
+                total.caller_wait_ns[caller] += counters->caller_wait_ns[caller].load(std::memory_order_relaxed);
+                total.caller_hold_ns[caller] += counters->caller_hold_ns[caller].load(std::memory_order_relaxed);
+            }
+        }
+    });
+    
+    auto usec = [](uint64_t ns) { return format_fixed(ns / 1000.0, 3); };
+    std::string info = "# Lockstats\r\nlock_profiling:" + std::string(lock_profiling.load() ? "yes" : "no") + "\r\n";
+    for (int lock = 0; lock < LOCK_COUNT; ++lock) {
+        const Totals& total = totals[lock];
+        if (total.acquisitions == 0) continue;
+        
+        std::string name = kLockNames[lock];
+        info += "lock_" + name + ":acquisitions=" + std::to_string(total.acquisitions) +
+                ",contended=" + std::to_string(total.contended) +
+                ",wait_usec=" + usec(total.wait_ns) +
+                ",wait_p50_usec=" + usec(LatencyHistogram::percentile(total.wait_hist, 50.0)) +
+                ",wait_p99_usec=" + usec(LatencyHistogram::percentile(total.wait_hist, 99.0)) +
+                ",wait_p99.9_usec=" + usec(LatencyHistogram::percentile(total.wait_hist, 99.9)) +
+                ",hold_usec=" + usec(total.hold_ns) +
+                ",hold_p50_usec=" + usec(LatencyHistogram::percentile(total.hold_hist, 50.0)) +
+                ",hold_p99_usec=" + usec(LatencyHistogram::percentile(total.hold_hist, 99.0)) +
+                ",hold_p99.9_usec=" + usec(LatencyHistogram::percentile(total.hold_hist, 99.9)) + "\r\n";
+        
+        for (int caller = 0; caller < LockCounters::kCallers; ++caller) {
+            if (total.caller_acquisitions[caller] == 0) continue;
+            std::string caller_name = caller == CMD_COUNT ? "background" : kCommandNames[caller];
+            info += "lock_" + name + "_" + caller_name + ":acquisitions=" +
+                    std::to_string(total.caller_acquisitions[caller]) +
+                    ",wait_usec=" + usec(total.caller_wait_ns[caller]) +
+                    ",hold_usec=" + usec(total.caller_hold_ns[caller]) + "\r\n";
+        }
+    }
+    return info;
+}
+
+std::string RedisClone::info_commandstats() {
+    std::array<uint64_t, CMD_COUNT> calls, total_ns;
+    collect_command_histograms(calls, total_ns);
+    
+    std::string info = "# Commandstats\r\n";
+    for (int i = 0; i < CMD_COUNT; ++i) {
+        if (calls[i] == 0) continue;
+        double usec = total_ns[i] / 1000.0;
+        info += "cmdstat_" + std::string(kCommandNames[i]) + ":calls=" + std::to_string(calls[i]) +
+                ",usec=" + std::to_string(static_cast<uint64_t>(usec)) +
+                ",usec_per_call=" + format_fixed(usec / calls[i], 2) + "\r\n";
+    }
+    return info;
+}
+
+std::string RedisClone::info_latencystats() {
+    std::array<uint64_t, CMD_COUNT> calls, total_ns;
+    auto histograms = collect_command_histograms(calls, total_ns);
+    
+    std::string info = "# Latencystats\r\n";
+    for (int i = 0; i < CMD_COUNT; ++i) {
+        if (calls[i] == 0) continue;
+        info += "latency_percentiles_usec_" + std::string(kCommandNames[i]) +
+                ":p50=" + format_fixed(LatencyHistogram::percentile(histograms[i], 50.0) / 1000.0, 3) +
+                ",p99=" + format_fixed(LatencyHistogram::percentile(histograms[i], 99.0) / 1000.0, 3) +
+                ",p99.9=" + format_fixed(LatencyHistogram::percentile(histograms[i], 99.9) / 1000.0, 3) + "\r\n";
+    }
+    return info;
+}
+
+void RedisClone::record_slowlog(WorkerStats* stats, const std::vector<std::string>& tokens, uint64_t duration_us) {
+    SlowlogEntry entry;
+    entry.id = slowlog_next_id.fetch_add(1, std::memory_order_relaxed);
+    entry.timestamp = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    entry.duration_us = duration_us;
+    entry.client_addr = tls_client_addr;
+    
+    size_t argc = std::min(tokens.size(), kSlowlogMaxArgs);
+    for (size_t i = 0; i < argc; ++i) {
+        if (argc < tokens.size() && i == argc - 1) {
+            entry.args.push_back("... (" + std::to_string(tokens.size() - argc + 1) + " more arguments)");
+        } else if (tokens[i].size() > kSlowlogMaxArgLen) {
+            entry.args.push_back(tokens[i].substr(0, kSlowlogMaxArgLen) + "... (" +
+                                 std::to_string(tokens[i].size() - kSlowlogMaxArgLen) + " more bytes)");
+        } else {
+            entry.args.push_back(tokens[i]);
+        }
+    }
+    
+    stats->slowlog.push(std::move(entry), slowlog_max_len.load(std::memory_order_relaxed));
+}
+
+std::string RedisClone::handle_slowlog(const std::vector<std::string>& tokens) {
+    if (tokens.size() < 2) return encode_error("ERR wrong number of arguments for 'slowlog' command");
+    
+    std::string sub = tokens[1];
+    std::transform(sub.begin(), sub.end(), sub.begin(), ::toupper);
+    size_t max_len = slowlog_max_len.load(std::memory_order_relaxed);
+    
+    if (sub == "LEN") {
+        size_t total = 0;
+        for_each_worker_stats([&](WorkerStats& stats) { total += stats.slowlog.size(); });
+        return encode_integer(std::min(total, max_len));
+    }
+    
+    if (sub == "RESET") {
+        for_each_worker_stats([](WorkerStats& stats) { stats.slowlog.clear(); });
+        return encode_simple_string("OK");
+    }
+    
+    if (sub == "GET") {
+        size_t count = 10;
+        if (tokens.size() > 2) {
+            try {
+                long long requested = std::stoll(tokens[2]);
+                count = requested < 0 ? max_len : static_cast<size_t>(requested);
+            } catch (...) {
+                return encode_error("ERR value is not an integer or out of range");
+            }
+        }
+        
+        std::vector<SlowlogEntry> entries;
+        for_each_worker_stats([&](WorkerStats& stats) { stats.slowlog.collect(entries); });
+        std::sort(entries.begin(), entries.end(),
+                  [](const SlowlogEntry& a, const SlowlogEntry& b) { return a.id > b.id; });
+        count = std::min({count, max_len, entries.size()});
+        
+        std::string result = encode_array_header(count);
+        for (size_t i = 0; i < count; ++i) {
+            const SlowlogEntry& entry = entries[i];
+            result += encode_array_header(6);
+            result += encode_integer(entry.id);
+            result += encode_integer(entry.timestamp);
+            result += encode_integer(entry.duration_us);
+            result += encode_array(entry.args);
+            result += encode_bulk_string(entry.client_addr);
+            result += encode_bulk_string("");
+        }
+        return result;
+    }
+    
+    return encode_error("ERR unknown subcommand '" + tokens[1] + "'. Try SLOWLOG GET, LEN, RESET");
+}
+
+std::string RedisClone::handle_latency(const std::vector<std::string>& tokens) {
+    if (tokens.size() < 2) return encode_error("ERR wrong number of arguments for 'latency' command");
+    
+    std::string sub = tokens[1];
+    std::transform(sub.begin(), sub.end(), sub.begin(), ::toupper);
+    
+    if (sub == "LATEST") {
+        auto events = latency_monitor.snapshot();
+        std::string result = encode_array_header(events.size());
+        for (const auto& event : events) {
+            const LatencySample& latest = event.second.samples.back();
+            result += encode_array_header(4);
+            result += encode_bulk_string(event.first);
+            result += encode_integer(latest.timestamp);
+            result += encode_integer(latest.latency_ms);
+            result += encode_integer(event.second.max_ms);
+        }
+        return result;
+    }
+    
+    if (sub == "HISTORY") {
+        if (tokens.size() != 3) return encode_error("ERR wrong number of arguments for 'latency|history' command");
+        auto events = latency_monitor.snapshot();
+        auto it = events.find(tokens[2]);
+        if (it == events.end()) return encode_array_header(0);
+        
+        std::string result = encode_array_header(it->second.samples.size());
+        for (const auto& sample : it->second.samples) {
+            result += encode_array_header(2);
+            result += encode_integer(sample.timestamp);
+            result += encode_integer(sample.latency_ms);
+        }
+        return result;
+    }
+    
+    if (sub == "RESET") {
+        std::vector<std::string> names(tokens.begin() + 2, tokens.end());
+        return encode_integer(latency_monitor.reset(names));
+    }
+    
+    if (sub == "DOCTOR") {
+        return encode_bulk_string(latency_doctor_report());
+    }
+    
+    return encode_error("ERR unknown subcommand '" + tokens[1] + "'. Try LATENCY LATEST, HISTORY, RESET, DOCTOR");
+}
+
+KeySizeInfo RedisClone::measure_key(const std::string& key, const RedisValue& value, std::string& encoding) {
+    static constexpr size_t kSizeSamples = 16;
+    static constexpr uint64_t kNodeOverhead = 32;
+    
+    KeySizeInfo info{key, 1, key.size() + sizeof(RedisValue)};
+    auto extrapolate = [&](uint64_t sampled_bytes, size_t sampled) {
+        if (sampled == 0) return;
+        info.bytes += sampled_bytes * info.elements / sampled + kNodeOverhead * info.elements;
+    };
+    
+    switch (value.type) {
+        case RedisValue::STRING: {
+            const std::string& str = *value.str_val;
+            info.bytes += str.size();
+            bool numeric = !str.empty() && str.size() <= 20 && std::all_of(str.begin(), str.end(), ::isdigit);
+            encoding = numeric ? "int" : str.size() <= 44 ? "embstr" : "raw";
+            break;
+        }
+        case RedisValue::LIST: {
+            info.elements = value.list_val.size();
+            uint64_t bytes = 0;
+            size_t sampled = 0;
+            for (auto it = value.list_val.begin(); it != value.list_val.end() && sampled < kSizeSamples; ++it, ++sampled) {
+                bytes += it->size();
+            }
+            extrapolate(bytes, sampled);
+            encoding = "linkedlist";
+            break;
+        }
+        case RedisValue::HASH: {
+            info.elements = value.hash_val.size();
+            uint64_t bytes = 0;
+            size_t sampled = 0;
+            for (auto it = value.hash_val.begin(); it != value.hash_val.end() && sampled < kSizeSamples; ++it, ++sampled) {
+                bytes += it->first.size() + it->second.size();
+            }
+            extrapolate(bytes, sampled);
+            encoding = "hashtable";
+            break;
+        }
+        case RedisValue::SET: {
+            info.elements = value.set_val.size();
+            uint64_t bytes = 0;
+            size_t sampled = 0;
+            for (auto it = value.set_val.begin(); it != value.set_val.end() && sampled < kSizeSamples; ++it, ++sampled) {
+                bytes += it->size();
+            }
+            extrapolate(bytes, sampled);
+            encoding = "rbtree";
+            break;
+        }
+    }
+    return info;
+}
+
+void RedisClone::analyze_keyspace(size_t sample_stride, size_t batch_keys, uint32_t sleep_usec) {
+    KeyspaceReport report;
+    {
+        std::lock_guard<std::mutex> lock(analysis_mutex);
+        report = analysis_report;
+    }
+    
+    size_t cursor = 0;
+    size_t bucket_count = 0;
+    std::string encoding;
+    
+    while (analysis_running) {
+        bool finished = false;
+        {
+            std::shared_lock<ProfiledSharedMutex> lock(data_mutex);
+            if (bucket_count != 0 && bucket_count != data.bucket_count()) {
+                cursor = cursor * data.bucket_count() / bucket_count;
+            }
+            bucket_count = data.bucket_count();
+            report.buckets_total = bucket_count;
+            
+            auto now = std::chrono::steady_clock::now();
+            size_t visited = 0;
+            while (cursor < bucket_count && visited < batch_keys) {
+                size_t bucket = cursor++;
+                visited++;
+                if (bucket % sample_stride != 0) continue;
+                
+                report.buckets_scanned++;
+                for (auto it = data.begin(bucket); it != data.end(bucket); ++it) {
+                    const RedisValue& value = *it->second;
+                    if (value.is_expired()) continue;
+                    
+                    KeySizeInfo info = measure_key(it->first, value, encoding);
+                    report.keys_scanned++;
+                    report.type_keys[value.type]++;
+                    report.type_bytes[value.type] += info.bytes;
+                    report.encodings[encoding]++;
+                    KeyspaceReport::offer(report.largest_by_elements[value.type], info, &KeySizeInfo::elements);
+                    KeyspaceReport::offer(report.largest_by_bytes[value.type], info, &KeySizeInfo::bytes);
+                    
+                    int ttl_bucket = 0;
+                    if (value.has_expiry) {
+                        auto ttl = std::chrono::duration_cast<std::chrono::seconds>(value.expiry - now).count();
+                        ttl_bucket = ttl < 60 ? 1 : ttl < 3600 ? 2 : ttl < 86400 ? 3 : 4;
+                    }
+                    report.ttl_histogram[ttl_bucket]++;
+                    visited++;
+                }
+            }
+            finished = cursor >= bucket_count;
+        }
+        
+        if (finished) {
+            report.status = "done";
+            report.finished_at = std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+        {
+            std::lock_guard<std::mutex> lock(analysis_mutex);
+            analysis_report = report;
+        }
+        if (finished) break;
+        
+        if (sleep_usec > 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(sleep_usec));
+        }
+    }
+    
+    if (report.status == "running") {
+        std::lock_guard<std::mutex> lock(analysis_mutex);
+        analysis_report.status = "stopped";
+    }
+    analysis_running = false;
+}
+
+void RedisClone::feed_monitor(WorkerStats* stats, const std::vector<std::string>& tokens) {
+    if (stats == &shared_worker_stats) return;
+    
+    uint64_t sequence = stats->monitor_sequence++;
+    if (sequence % monitor_sample_stride.load(std::memory_order_relaxed) != 0) return;
+    
+    int64_t now_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    if (!stats->monitor.push(sequence, now_us, tokens, tls_client_addr)) {
+        monitor_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+std::string RedisClone::format_monitor_record(const MonitorRing::Record& record) {
+    char timestamp[32];
+    snprintf(timestamp, sizeof(timestamp), "%lld.%06lld",
+             static_cast<long long>(record.timestamp_us / 1000000),
+             static_cast<long long>(record.timestamp_us % 1000000));
+    
+    std::string line = "+" + std::string(timestamp) + " [0 " + record.client_addr + "]";
+    for (const auto& arg : record.args) {
+        line += " \"";
+        for (unsigned char c : arg) {
+            if (c == '"' || c == '\\') {
+                line += '\\';
+                line += c;
+            } else if (c < 32 || c > 126) {
+                char escaped[8];
+                snprintf(escaped, sizeof(escaped), "\\x%02x", c);
+                line += escaped;
+            } else {
+                line += c;
+            }
+        }
+        line += "\"";
+    }
+    return line + "\r\n";
+}
+
+std::string RedisClone::format_client_info(ClientInfo& client, int64_t now_ns) {
+    int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    int64_t idle_ns = now_ns - client.last_interaction_ns.load(std::memory_order_relaxed);
+    int command = client.current_command.load(std::memory_order_relaxed);
+    
+    std::string line = "id=" + std::to_string(client.id.load(std::memory_order_relaxed));
+    {
+        std::lock_guard<std::mutex> lock(client.info_mutex);
+        if (!client.active) return "";
+        line += " addr=" + client.addr + " fd=" + std::to_string(client.fd) + " name=" + client.name +
+                " age=" + std::to_string(now - client.created_at);
+    }
+    line += " idle=" + std::to_string(std::max<int64_t>(0, idle_ns) / 1000000000) +
+            " qbuf=" + std::to_string(client.query_buffer.load(std::memory_order_relaxed)) +
+            " obuf=" + std::to_string(client.output_buffer.load(std::memory_order_relaxed)) +
+            " tot-net-in=" + std::to_string(client.net_input_bytes.load(std::memory_order_relaxed)) +
+            " tot-net-out=" + std::to_string(client.net_output_bytes.load(std::memory_order_relaxed)) +
+            " tot-cmds=" + std::to_string(client.commands.load(std::memory_order_relaxed)) +
+            " cmd=" + (command == CMD_COUNT ? "NULL" : kCommandNames[command]) + "\n";
+    return line;
+}
+
+std::string RedisClone::handle_client_command(const std::vector<std::string>& tokens) {
+    if (tokens.size() < 2) return encode_error("ERR wrong number of arguments for 'client' command");
+    
+    std::string sub = tokens[1];
+    std::transform(sub.begin(), sub.end(), sub.begin(), ::toupper);
+    ClientInfo* self = tls_worker_stats ? &tls_worker_stats->client : nullptr;
+    
+    if (sub == "LIST" && tokens.size() == 2) {
+        int64_t now_ns = steady_now_ns();
+        std::string list;
+        for_each_worker_stats([&](WorkerStats& stats) {
+            list += format_client_info(stats.client, now_ns);
+        });
+        return encode_bulk_string(list);
+    }
+    if (sub == "INFO" && tokens.size() == 2) {
+        if (!self) return encode_error("ERR CLIENT INFO requires a client connection");
+        return encode_bulk_string(format_client_info(*self, steady_now_ns()));
+    }
+    if (sub == "ID" && tokens.size() == 2) {
+        if (!self) return encode_error("ERR CLIENT ID requires a client connection");
+        return encode_integer(self->id.load());
+    }
+    if (sub == "SETNAME" && tokens.size() == 3) {
+        if (!self) return encode_error("ERR CLIENT SETNAME requires a client connection");
+        std::lock_guard<std::mutex> lock(self->info_mutex);
+        self->name = tokens[2];
+        return encode_simple_string("OK");
+    }
+    if (sub == "GETNAME" && tokens.size() == 2) {
+        if (!self) return encode_error("ERR CLIENT GETNAME requires a client connection");
+        std::lock_guard<std::mutex> lock(self->info_mutex);
+        return self->name.empty() ? "$-1\r\n" : encode_bulk_string(self->name);
+    }
+    if (sub == "KILL" && (tokens.size() == 3 || tokens.size() == 4)) {
+        std::string filter = "ADDR";
+        std::string value = tokens[2];
+        if (tokens.size() == 4) {
+            filter = tokens[2];
+            std::transform(filter.begin(), filter.end(), filter.begin(), ::toupper);
+            value = tokens[3];
+            if (filter != "ADDR" && filter != "ID") return encode_error("ERR syntax error");
+        }
+        
+        long long killed = 0;
+        for_each_worker_stats([&](WorkerStats& stats) {
+            ClientInfo& client = stats.client;
+            std::lock_guard<std::mutex> lock(client.info_mutex);
+            if (!client.active) return;
+            bool match = filter == "ID" ? std::to_string(client.id.load()) == value : client.addr == value;
+            if (!match) return;
+            
+            // The owning thread sees EOF on its next recv and cleans up.
+            client.killed = true;
+            shutdown(client.fd, SHUT_RDWR);
+            ++killed;
+        });
+        
+        if (tokens.size() == 3) {
+            return killed ? encode_simple_string("OK") : encode_error("ERR No such client");
+        }
+        return encode_integer(killed);
+    }
+    return encode_error("ERR unknown subcommand or wrong number of arguments for 'client' command");
+}
+
+std::string RedisClone::handle_monitor(const std::vector<std::string>& tokens) {
+    if (tls_client_fd < 0) return encode_error("ERR MONITOR requires a client connection");
+    
+    MonitorClient client{tls_client_fd, "", 1, ""};
+    try {
+        for (size_t i = 1; i < tokens.size(); ++i) {
+            std::string option = tokens[i];
+            std::transform(option.begin(), option.end(), option.begin(), ::toupper);
+            if (option == "SAMPLE" && i + 1 < tokens.size()) {
+                client.sample_rate = std::max<uint32_t>(1, std::stoul(tokens[++i]));
+            } else if (option == "PREFIX" && i + 1 < tokens.size()) {
+                client.prefix = tokens[++i];
+            } else {
+                return encode_error("ERR syntax error");
+            }
+        }
+    } catch (...) {
+        return encode_error("ERR value is not an integer or out of range");
+    }
+    
+    std::lock_guard<std::mutex> lock(monitor_mutex);
+    auto existing = std::find_if(monitor_clients.begin(), monitor_clients.end(),
+                                 [&](const MonitorClient& monitor) { return monitor.fd == client.fd; });
+    if (existing != monitor_clients.end()) {
+        existing->prefix = client.prefix;
+        existing->sample_rate = client.sample_rate;
+    } else {
+        monitor_clients.push_back(client);
+    }
+    update_monitor_stride();
+    // From here on replies go out through the drain thread, copied inline.
+    tls_monitoring = true;
+    tls_reply_refs = nullptr;
+    monitor_active = true;
+    
+    if (!monitor_drain_running) {
+        if (monitor_thread.joinable()) {
+            monitor_thread.join();
+        }
+        monitor_drain_running = true;
+        monitor_thread = std::thread(&RedisClone::drain_monitors, this);
+    }
+    return encode_simple_string("OK");
+}
+
+std::string RedisClone::handle_bigkeys(const std::vector<std::string>& tokens) {
+    if (tokens.size() < 2) return encode_error("ERR wrong number of arguments for 'bigkeys' command");
+    
+    std::string sub = tokens[1];
+    std::transform(sub.begin(), sub.end(), sub.begin(), ::toupper);
+    
+    if (sub == "START") {
+        size_t sample_percent = 100;
+        size_t batch_keys = 100;
+        uint32_t sleep_usec = 1000;
+        
+        try {
+            for (size_t i = 2; i < tokens.size(); ++i) {
+                std::string option = tokens[i];
+                std::transform(option.begin(), option.end(), option.begin(), ::toupper);
+                if (option == "FULL") {
+                    sample_percent = 100;
+                } else if (option == "SAMPLE" && i + 1 < tokens.size()) {
+                    sample_percent = std::stoul(tokens[++i]);
+                } else if (option == "BATCH" && i + 1 < tokens.size()) {
+                    batch_keys = std::stoul(tokens[++i]);
+                } else if (option == "SLEEP" && i + 1 < tokens.size()) {
+                    sleep_usec = std::stoul(tokens[++i]);
+                } else {
+                    return encode_error("ERR syntax error");
+                }
+            }
+        } catch (...) {
+            return encode_error("ERR value is not an integer or out of range");
+        }
+        if (sample_percent == 0 || sample_percent > 100 || batch_keys == 0) {
+            return encode_error("ERR SAMPLE must be 1-100 and BATCH positive");
+        }
+        
+        if (analysis_running.exchange(true)) {
+            return encode_error("ERR keyspace analysis already running");
+        }
+        if (analysis_thread.joinable()) {
+            analysis_thread.join();
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(analysis_mutex);
+            analysis_report = KeyspaceReport();
+            analysis_report.status = "running";
+            analysis_report.mode = sample_percent == 100 ? "full" : "sample:" + std::to_string(sample_percent) + "%";
+            analysis_report.started_at = std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+        analysis_thread = std::thread(&RedisClone::analyze_keyspace, this,
+                                      100 / sample_percent, batch_keys, sleep_usec);
+        return encode_simple_string("OK");
+    }
+    
+    if (sub == "STOP") {
+        analysis_running = false;
+        if (analysis_thread.joinable()) {
+            analysis_thread.join();
+        }
+        return encode_simple_string("OK");
+    }
+    
+    if (sub == "REPORT") {
+        return encode_bulk_string(keyspace_analysis_report());
+    }
+    
+    return encode_error("ERR unknown subcommand '" + tokens[1] + "'. Try BIGKEYS START, STOP, REPORT");
+}
+
+std::string RedisClone::keyspace_analysis_report() {
+    KeyspaceReport report;
+    {
+        std::lock_guard<std::mutex> lock(analysis_mutex);
+        report = analysis_report;
+    }
+    
+    std::string text = "status: " + report.status + "\n";
+    if (report.status == "idle") return text;
+    
+    text += "mode: " + report.mode + "\n";
+    text += "buckets scanned: " + std::to_string(report.buckets_scanned) + "/" +
+            std::to_string(report.buckets_total) + "\n";
+    text += "keys scanned: " + std::to_string(report.keys_scanned) + "\n";
+    
+    for (int type = 0; type < KeyspaceReport::kTypeCount; ++type) {
+        if (report.type_keys[type] == 0) continue;
+        text += "\n" + std::string(KeyspaceReport::type_name(type)) + ": " + std::to_string(report.type_keys[type]) +
+                " keys, ~" + std::to_string(report.type_bytes[type]) + " bytes\n";
+        text += "  largest by elements:\n";
+        for (const auto& info : report.largest_by_elements[type]) {
+            text += "    " + info.key + " elements=" + std::to_string(info.elements) +
+                    " bytes=" + std::to_string(info.bytes) + "\n";
+        }
+        text += "  largest by bytes:\n";
+        for (const auto& info : report.largest_by_bytes[type]) {
+            text += "    " + info.key + " bytes=" + std::to_string(info.bytes) +
+                    " elements=" + std::to_string(info.elements) + "\n";
+        }
+    }
+    
+    text += "\nencodings:\n";
+    for (const auto& encoding : report.encodings) {
+        text += "  " + encoding.first + ": " + std::to_string(encoding.second) + "\n";
+    }
+    text += "\nttl histogram:\n";
+    for (int bucket = 0; bucket < KeyspaceReport::kTtlBuckets; ++bucket) {
+        text += "  " + std::string(KeyspaceReport::ttl_bucket_name(bucket)) + ": " +
+                std::to_string(report.ttl_histogram[bucket]) + "\n";
+    }
+    return text;
+}
+
+std::string RedisClone::info_keyspace_analysis() {
+    KeyspaceReport report;
+    {
+        std::lock_guard<std::mutex> lock(analysis_mutex);
+        report = analysis_report;
+    }
+    
+    std::string info = "# Keyspace_analysis\r\nanalysis_status:" + report.status + "\r\n";
+    if (report.status == "idle") return info;
+    
+    info += "analysis_mode:" + report.mode + "\r\n";
+    info += "analysis_started_at:" + std::to_string(report.started_at) + "\r\n";
+    info += "analysis_finished_at:" + std::to_string(report.finished_at) + "\r\n";
+    info += "analysis_buckets_scanned:" + std::to_string(report.buckets_scanned) + "\r\n";
+    info += "analysis_keys_scanned:" + std::to_string(report.keys_scanned) + "\r\n";
+    for (int type = 0; type < KeyspaceReport::kTypeCount; ++type) {
+        std::string name = KeyspaceReport::type_name(type);
+        info += name + "_keys:" + std::to_string(report.type_keys[type]) + "\r\n";
+        info += name + "_bytes:" + std::to_string(report.type_bytes[type]) + "\r\n";
+        if (!report.largest_by_elements[type].empty()) {
+            const KeySizeInfo& biggest = report.largest_by_elements[type].front();
+            info += "biggest_" + name + ":key=" + biggest.key + ",elements=" + std::to_string(biggest.elements) +
+                    ",bytes=" + std::to_string(biggest.bytes) + "\r\n";
+        }
+    }
+    for (const auto& encoding : report.encodings) {
+        info += "encoding_" + encoding.first + ":" + std::to_string(encoding.second) + "\r\n";
+    }
+    for (int bucket = 0; bucket < KeyspaceReport::kTtlBuckets; ++bucket) {
+        info += "ttl_" + std::string(KeyspaceReport::ttl_bucket_name(bucket)) + ":" +
+                std::to_string(report.ttl_histogram[bucket]) + "\r\n";
+    }
+    return info;
+}
+
+std::string RedisClone::handle_hotkeys(const std::vector<std::string>& tokens) {
+    size_t count = 10;
+    if (tokens.size() > 1) {
+        try {
+            count = std::stoul(tokens[1]);
+        } catch (...) {
+            return encode_error("ERR value is not an integer or out of range");
+        }
+    }
+    
+    std::unordered_map<std::string, uint64_t> merged;
+    uint64_t epoch = hotkeys_decay_epoch.load();
+    worker_stats.for_each([&](WorkerStats& stats) { stats.hotkeys.collect(merged, epoch); });
+    
+    std::vector<std::pair<std::string, uint64_t>> ranked(merged.begin(), merged.end());
+    std::sort(ranked.begin(), ranked.end(),
+              [](const std::pair<std::string, uint64_t>& a, const std::pair<std::string, uint64_t>& b) {
+                  return a.second > b.second;
+              });
+    if (ranked.size() > count) ranked.resize(count);
+    
+    uint64_t rate = std::max<uint32_t>(1, hotkeys_sample_rate.load());
+    std::string result = encode_array_header(ranked.size() * 2);
+    for (const auto& entry : ranked) {
+        result += encode_bulk_string(entry.first);
+        result += encode_integer(entry.second * rate);
+    }
+    return result;
+}
+
+std::string RedisClone::latency_doctor_report() {
+    uint64_t threshold = latency_threshold_ms.load();
+    if (threshold == 0) {
+        return "The latency monitor is disabled. Enable it with "
+               "CONFIG SET latency-monitor-threshold <milliseconds>.\n";
+    }
+    
+    auto events = latency_monitor.snapshot();
+    if (events.empty()) {
+        return "No latency spikes above " + std::to_string(threshold) + " ms were observed.\n";
+    }
+    
+    std::string report = "Latency spikes above " + std::to_string(threshold) + " ms:\n\n";
+    int index = 1;
+    for (const auto& event : events) {
+        const auto& samples = event.second.samples;
+        uint64_t sum = 0;
+        for (const auto& sample : samples) sum += sample.latency_ms;
+        double avg = static_cast<double>(sum) / samples.size();
+        
+        double deviation = 0;
+        for (const auto& sample : samples) deviation += std::abs(static_cast<double>(sample.latency_ms) - avg);
+        deviation /= samples.size();
+        
+        int64_t span = samples.back().timestamp - samples.front().timestamp;
+        report += std::to_string(index++) + ". " + event.first + ": " + std::to_string(samples.size()) +
+                  " latency spikes (average " + format_fixed(avg, 0) + "ms, mean deviation " +
+                  format_fixed(deviation, 0) + "ms, period " +
+                  format_fixed(samples.size() > 1 ? static_cast<double>(span) / (samples.size() - 1) : 0, 2) +
+                  " sec). Worst all time event " + std::to_string(event.second.max_ms) + "ms.\n";
+    }
+    
+    report += "\nAdvice:\n";
+    if (events.count("command")) {
+        report += "- Slow commands are being served. Check SLOWLOG GET and INFO latencystats for "
+                  "O(N) commands such as HGETALL, SMEMBERS or LRANGE on large keys.\n";
+    }
+    if (events.count("expire-cycle")) {
+        report += "- The expiry sweep holds the keyspace lock while it scans every key. Large "
+                  "keyspaces or many keys expiring at once make it block clients.\n";
+    }
+    if (events.count("rehash")) {
+        report += "- Growing the keyspace table blocks writers while every key is rehashed. "
+                  "Spikes here track keyspace growth.\n";
+    }
+    return report;
+}
+
+std::string RedisClone::handle_config(const std::vector<std::string>& tokens) {
+    if (tokens.size() < 3) return encode_error("ERR wrong number of arguments for 'config' command");
+    
+    std::string sub = tokens[1];
+    std::transform(sub.begin(), sub.end(), sub.begin(), ::toupper);
+    
+    if (sub == "GET") {
+        std::vector<std::string> result;
+        for (const auto& name : config_names()) {
+            if (tokens[2] == "*" || tokens[2] == name) {
+                result.push_back(name);
+                result.push_back(config_get(name));
+            }
+        }
+        return encode_array(result);
+    }
+    
+    if (sub == "SET") {
+        if (tokens.size() < 4) return encode_error("ERR wrong number of arguments for 'config' command");
+        std::string error = config_set(tokens[2], tokens[3]);
+        return error.empty() ? encode_simple_string("OK") : encode_error(error);
+    }
+    
+    return encode_error("ERR unknown subcommand '" + tokens[1] + "'. Try CONFIG GET, SET");
+}
+
+std::string RedisClone::render_metrics() {
+    static const double kBucketBoundsSeconds[] = {
+        0.000001, 0.0000025, 0.000005, 0.00001, 0.000025, 0.00005, 0.0001, 0.00025, 0.0005,
+        0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0
+    };
+    
+    std::string out;
+    auto metric = [&out](const std::string& name, const char* type, const char* help) {
+        out += "# HELP " + name + " " + help + "\n# TYPE " + name + " " + type + "\n";
+    };
+    
+    metric("redis_connected_clients", "gauge", "Number of client connections.");
+    out += "redis_connected_clients " + std::to_string(connection_pool.get_active_count()) + "\n";
+    metric("redis_connections_received_total", "counter", "Connections accepted since startup.");
+    out += "redis_connections_received_total " + std::to_string(total_connections_received.load()) + "\n";
+    
+    metric("redis_memory_rss_bytes", "gauge", "Resident set size of the server process.");
+    out += "redis_memory_rss_bytes " + std::to_string(read_rss_bytes()) + "\n";
+    
+    metric("redis_keyspace_keys", "gauge", "Keys in the keyspace as of the last expiry sweep.");
+    out += "redis_keyspace_keys " + std::to_string(keyspace_keys.load()) + "\n";
+    metric("redis_keyspace_expires", "gauge", "Keys with a TTL as of the last expiry sweep.");
+    out += "redis_keyspace_expires " + std::to_string(keyspace_expires.load()) + "\n";
+    metric("redis_expired_keys_total", "counter", "Keys removed by the expiry sweep.");
+    out += "redis_expired_keys_total " + std::to_string(expired_keys_total.load()) + "\n";
+    metric("redis_evicted_keys_total", "counter", "Keys evicted to stay under maxkeys.");
+    out += "redis_evicted_keys_total " + std::to_string(evicted_keys_total.load()) + "\n";
+    metric("redis_expire_cycles_total", "counter", "Completed expiry sweeps.");
+    out += "redis_expire_cycles_total " + std::to_string(expire_cycles_total.load()) + "\n";
+    metric("redis_expire_cycle_last_duration_seconds", "gauge", "Duration of the most recent expiry sweep.");
+    out += "redis_expire_cycle_last_duration_seconds " + format_fixed(expire_cycle_last_ns.load() / 1e9, 9) + "\n";
+    
+    std::string worker_commands, worker_input, worker_output;
+    int worker = 0;
+    worker_stats.for_each([&](WorkerStats& stats) {
+        uint64_t calls = 0;
+        for (int i = 0; i < CMD_COUNT; ++i) {
+            const CommandCounters* counters = stats.command(static_cast<CommandId>(i));
+            if (counters) calls += counters->calls.load(std::memory_order_relaxed);
+        }
+        std::string label = "{worker=\"" + std::to_string(worker++) + "\"} ";
+        worker_commands += "redis_worker_commands_total" + label + std::to_string(calls) + "\n";
+        worker_input += "redis_worker_net_input_bytes_total" + label +
+                        std::to_string(stats.net_input_bytes.load(std::memory_order_relaxed)) + "\n";
+        worker_output += "redis_worker_net_output_bytes_total" + label +
+                         std::to_string(stats.net_output_bytes.load(std::memory_order_relaxed)) + "\n";
+    });
+    metric("redis_worker_commands_total", "counter", "Commands processed per connection thread slot.");
+    out += worker_commands;
+    metric("redis_worker_net_input_bytes_total", "counter", "Bytes read per connection thread slot.");
+    out += worker_input;
+    metric("redis_worker_net_output_bytes_total", "counter", "Bytes written per connection thread slot.");
+    out += worker_output;
+    
+    std::array<uint64_t, CMD_COUNT> calls, total_ns;
+    auto histograms = collect_command_histograms(calls, total_ns);
+    
+    metric("redis_commands_total", "counter", "Calls per command.");
+    for (int i = 0; i < CMD_COUNT; ++i) {
+        if (calls[i] == 0) continue;
+        out += "redis_commands_total{cmd=\"" + std::string(kCommandNames[i]) + "\"} " +
+               std::to_string(calls[i]) + "\n";
+    }
+    
+    metric("redis_command_duration_seconds", "histogram", "Command execution time.");
+    for (int i = 0; i < CMD_COUNT; ++i) {
+        if (calls[i] == 0) continue;
+        std::string label = "cmd=\"" + std::string(kCommandNames[i]) + "\"";
+        
+        int bucket = 0;
+        uint64_t cumulative = 0;
+        for (double bound : kBucketBoundsSeconds) {
+            uint64_t bound_ns = static_cast<uint64_t>(bound * 1e9);
+            while (bucket < LatencyHistogram::kBucketCount &&
+                   LatencyHistogram::bucket_upper_bound(bucket) <= bound_ns) {
+                cumulative += histograms[i][bucket++];
+            }
+            char le[32];
+            snprintf(le, sizeof(le), "%g", bound);
+            out += "redis_command_duration_seconds_bucket{" + label + ",le=\"" + le + "\"} " +
+                   std::to_string(cumulative) + "\n";
+        }
+        out += "redis_command_duration_seconds_bucket{" + label + ",le=\"+Inf\"} " + std::to_string(calls[i]) + "\n";
+        out += "redis_command_duration_seconds_sum{" + label + "} " + format_fixed(total_ns[i] / 1e9, 9) + "\n";
+        out += "redis_command_duration_seconds_count{" + label + "} " + std::to_string(calls[i]) + "\n";
+    }
+    return out;
+}
+
+// There is a single database, so FLUSHDB is the same as FLUSHALL. ASYNC
+// swaps the keyspace out in O(1) and leaves destroying it to lazyfree_thread.
+std::string RedisClone::handle_flushall(const std::vector<std::string>& tokens) {
+    bool async = false;
+    if (tokens.size() == 2) {
+        std::string mode = tokens[1];
+        std::transform(mode.begin(), mode.end(), mode.begin(), ::toupper);
+        if (mode != "ASYNC" && mode != "SYNC") return encode_error("ERR syntax error");
+        async = mode == "ASYNC";
+    } else if (tokens.size() > 2) {
+        return encode_error("ERR syntax error");
+    }
+    
+    auto detached = std::make_unique<Keyspace>();
+    std::unique_lock<ProfiledSharedMutex> lock(data_mutex);
+    detached->swap(data);
+    key_index.clear();
+    lock.unlock();
+    
+    if (async && !detached->empty()) {
+        std::lock_guard<std::mutex> lazyfree_lock(lazyfree_mutex);
+        lazyfree_pending_objects.fetch_add(detached->size(), std::memory_order_relaxed);
+        lazyfree_keyspaces.push_back(std::move(detached));
+        lazyfree_cv.notify_one();
+    }
+    return encode_simple_string("OK");
+}
+
+RedisClone::RedisClone() {
+    data_mutex.attach_profiler(&lock_profiling, &shared_worker_stats.locks);
+    pubsub_manager.mutex().attach_profiler(&lock_profiling, &shared_worker_stats.locks);
+    cleanup_thread = std::thread(&RedisClone::cleanup_expired_keys, this);
+    read_epochs.set_reclaimer([this]() { wake_lazyfree(); });
+    lazyfree_thread = std::thread(&RedisClone::lazyfree_loop, this);
+}
+
+RedisClone::~RedisClone() {
+    running = false;
+    analysis_running = false;
+    if (analysis_thread.joinable()) {
+        analysis_thread.join();
+    }
+    if (cleanup_thread.joinable()) {
+        cleanup_thread.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(lazyfree_mutex);
+        lazyfree_cv.notify_one();
+    }
+    if (lazyfree_thread.joinable()) {
+        lazyfree_thread.join();
+    }
+    read_epochs.set_reclaimer(nullptr);
+    
+    // Pins the kernel has still not released are leaked on purpose: freeing
+    // them could hand pages still queued for transmission back to malloc.
+    for (auto& orphan : zerocopy_orphans) {
+        new std::deque<std::pair<uint32_t, SharedValue>>(std::move(orphan.pins.pending));
+        close(orphan.fd);
+    }
+    if (monitor_thread.joinable()) {
+        monitor_thread.join();
+    }
+    
+    int fd = metrics_fd.exchange(-1);
+    if (fd >= 0) {
+        shutdown(fd, SHUT_RDWR);
+        close(fd);
+    }
+    if (metrics_thread.joinable()) {
+        metrics_thread.join();
+    }
+}
+
+const std::vector<std::string>& RedisClone::config_names() {
+    static const std::vector<std::string> names = {
+        "slowlog-log-slower-than", "slowlog-max-len", "latency-monitor-threshold", "metrics-port",
+        "hotkeys-sample-rate", "hotkeys-decay-time", "lock-profiling", "maxkeys", "maxkeys-policy",
+        "zerocopy-threshold", "lazyfree-lazy-user-del", "lazyfree-lazy-expire", "lazyfree-lazy-eviction"
+    };
+    return names;
+}
+
+std::string RedisClone::config_get(const std::string& name) {
+    if (name == "slowlog-log-slower-than") return std::to_string(slowlog_slower_than.load());
+    if (name == "slowlog-max-len") return std::to_string(slowlog_max_len.load());
+    if (name == "latency-monitor-threshold") return std::to_string(latency_threshold_ms.load());
+    if (name == "metrics-port") return std::to_string(metrics_port);
+    if (name == "hotkeys-sample-rate") return std::to_string(hotkeys_sample_rate.load());
+    if (name == "hotkeys-decay-time") return std::to_string(hotkeys_decay_seconds.load());
+    if (name == "lock-profiling") return lock_profiling.load() ? "yes" : "no";
+    if (name == "maxkeys") return std::to_string(maxkeys.load());
+    if (name == "maxkeys-policy") return kEvictionPolicyNames[eviction_policy.load()];
+    if (name == "zerocopy-threshold") return std::to_string(zerocopy_threshold.load());
+    if (name == "lazyfree-lazy-user-del") return lazyfree_user_del.load() ? "yes" : "no";
+    if (name == "lazyfree-lazy-expire") return lazyfree_expire.load() ? "yes" : "no";
+    if (name == "lazyfree-lazy-eviction") return lazyfree_eviction.load() ? "yes" : "no";
+    return "";
+}
+
+std::string RedisClone::config_set(const std::string& name, const std::string& value) {
+    if (name == "lock-profiling") {
+        if (value != "yes" && value != "no") return "ERR Invalid argument '" + value + "' for CONFIG SET '" + name + "'";
+        lock_profiling = value == "yes";
+        return "";
+    }
+    if (name == "lazyfree-lazy-user-del" || name == "lazyfree-lazy-expire" || name == "lazyfree-lazy-eviction") {
+        if (value != "yes" && value != "no") return "ERR Invalid argument '" + value + "' for CONFIG SET '" + name + "'";
+        (name == "lazyfree-lazy-user-del" ? lazyfree_user_del
+         : name == "lazyfree-lazy-expire" ? lazyfree_expire : lazyfree_eviction) = value == "yes";
+        return "";
+    }
+    if (name == "maxkeys-policy") {
+        auto policy = std::find(std::begin(kEvictionPolicyNames), std::end(kEvictionPolicyNames), value);
+        if (policy == std::end(kEvictionPolicyNames)) return "ERR Invalid argument '" + value + "' for CONFIG SET '" + name + "'";
+        eviction_policy = static_cast<int>(policy - std::begin(kEvictionPolicyNames));
+        return "";
+    }
+    
+    long long parsed;
+    try {
+        size_t consumed;
+        parsed = std::stoll(value, &consumed);
+        if (consumed != value.size()) throw std::invalid_argument(value);
+    } catch (...) {
+        return "ERR Invalid argument '" + value + "' for CONFIG SET '" + name + "'";
+    }
+    
+    if (name == "slowlog-log-slower-than") {
+        slowlog_slower_than = parsed;
+    } else if (name == "slowlog-max-len") {
+        if (parsed < 0) return "ERR Invalid argument '" + value + "' for CONFIG SET '" + name + "'";
+        slowlog_max_len = static_cast<size_t>(parsed);
+    } else if (name == "latency-monitor-threshold") {
+        if (parsed < 0) return "ERR Invalid argument '" + value + "' for CONFIG SET '" + name + "'";
+        latency_threshold_ms = static_cast<uint64_t>(parsed);
+    } else if (name == "metrics-port") {
+        if (metrics_thread.joinable()) return "ERR metrics-port can only be set at startup";
+        if (parsed < 0 || parsed > 65535) return "ERR Invalid argument '" + value + "' for CONFIG SET '" + name + "'";
+        metrics_port = static_cast<int>(parsed);
+    } else if (name == "hotkeys-sample-rate" || name == "hotkeys-decay-time") {
+        if (parsed < 0 || parsed > UINT32_MAX) return "ERR Invalid argument '" + value + "' for CONFIG SET '" + name + "'";
+        (name == "hotkeys-sample-rate" ? hotkeys_sample_rate : hotkeys_decay_seconds) = static_cast<uint32_t>(parsed);
+    } else if (name == "maxkeys") {
+        if (parsed < 0) return "ERR Invalid argument '" + value + "' for CONFIG SET '" + name + "'";
+        maxkeys = static_cast<uint64_t>(parsed);
+    } else if (name == "zerocopy-threshold") {
+        if (parsed < 0) return "ERR Invalid argument '" + value + "' for CONFIG SET '" + name + "'";
+        zerocopy_threshold = static_cast<uint64_t>(parsed);
+    } else {
+        return "ERR Unknown option or number of arguments for CONFIG SET - '" + name + "'";
+    }
+    return "";
+}
+
+std::string RedisClone::execute(const std::vector<std::string>& args) {
+    std::string reply;
+    process_command(args, reply);
+    return reply;
+}
+
+std::string RedisClone::execute(size_t argc, const char* const* argv, const size_t* argv_len) {
+    std::vector<std::string> args;
+    args.reserve(argc);
+    for (size_t i = 0; i < argc; ++i) {
+        args.emplace_back(argv[i], argv_len[i]);
+    }
+    return execute(args);
+}
+
+void RedisClone::subscribe_client(int client_fd, const std::string& channel) {
+    pubsub_manager.subscribe(channel, client_fd);
+}
+
+void RedisClone::unsubscribe_client(int client_fd, const std::string& channel) {
+    pubsub_manager.unsubscribe(channel, client_fd);
+}
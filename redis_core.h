@@ -0,0 +1,1517 @@
+#ifndef REDIS_CLONE_CORE_H
+#define REDIS_CLONE_CORE_H
+
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <list>
+#include <set>
+#include <map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <algorithm>
+#include <queue>
+#include <deque>
+#include <functional>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+#include <numeric>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+
+#include "resp.h"
+
+// Static tracepoints for perf/bpftrace/SystemTap, compiled in with
+// -DREDIS_CLONE_USDT (make usdt). Without it every probe compiles to nothing.
+// The probe list is documented in Readme.md.
+#ifdef REDIS_CLONE_USDT
+#include <sys/sdt.h>
+#define TRACE_PROBE(name) DTRACE_PROBE(redis_clone, name)
+#define TRACE_PROBE1(name, a) DTRACE_PROBE1(redis_clone, name, a)
+#define TRACE_PROBE2(name, a, b) DTRACE_PROBE2(redis_clone, name, a, b)
+#define TRACE_PROBE3(name, a, b, c) DTRACE_PROBE3(redis_clone, name, a, b, c)
+#else
+#define TRACE_PROBE(name) do {} while (0)
+#define TRACE_PROBE1(name, a) do { (void)sizeof(a); } while (0)
+#define TRACE_PROBE2(name, a, b) do { (void)sizeof(a); (void)sizeof(b); } while (0)
+#define TRACE_PROBE3(name, a, b, c) do { (void)sizeof(a); (void)sizeof(b); (void)sizeof(c); } while (0)
+#endif
+
+// Immutable, refcounted string storage. Writers never modify one in place:
+// SET swaps in a new buffer, so a reader holding a reference can encode it
+// after dropping data_mutex, and a reply can reference it directly (see
+// ReplyRef) for writev instead of copying it into the reply buffer.
+using SharedValue = std::shared_ptr<const std::string>;
+
+class RedisValue {
+public:
+    enum Type { STRING, LIST, HASH, SET };
+    
+    Type type;
+    SharedValue str_val;
+    std::list<std::string> list_val;
+    std::unordered_map<std::string, std::string> hash_val;
+    std::set<std::string> set_val;
+    std::chrono::steady_clock::time_point expiry;
+    bool has_expiry = false;
+    std::atomic<uint32_t> last_access{0};
+    
+    RedisValue(Type t) : type(t) {}
+    
+    // Readers call this without the exclusive lock; the check keeps repeated
+    // reads of a hot key from writing its cache line every time.
+    void touch(uint32_t clock) {
+        if (last_access.load(std::memory_order_relaxed) != clock) {
+            last_access.store(clock, std::memory_order_relaxed);
+        }
+    }
+    
+    void assign_string(std::string value) {
+        str_val = std::make_shared<const std::string>(std::move(value));
+    }
+    
+    bool is_expired() const {
+        return has_expiry && std::chrono::steady_clock::now() > expiry;
+    }
+    
+    void set_expiry(int seconds) {
+        has_expiry = true;
+        expiry = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+    }
+};
+
+// Epoch-based reclamation for the lock-free read path. A reader publishes
+// the epoch it entered in its own cache line and writes nothing shared.
+// Writers retire objects after unlinking them; an object is freed once every
+// reader still inside a section entered after it was retired.
+class EpochDomain {
+public:
+    // Threads past this many get no slot and fall back to data_mutex.
+    static constexpr int kMaxThreads = 2048;
+    static constexpr size_t kReclaimBatch = 256;
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> epoch{0};
+    };
+    
+    struct Retired {
+        uint64_t epoch;
+        void* object;
+        void (*destroy)(void*);
+    };
+    
+    // Thread indices are process-wide, so one thread uses the same slot in
+    // every domain. An index is returned when its thread exits.
+    struct ThreadIndices {
+        std::mutex mutex;
+        std::vector<int> free;
+        std::atomic<int> high{0};
+    };
+    
+    static ThreadIndices& thread_indices() {
+        static ThreadIndices indices;
+        return indices;
+    }
+    
+    struct ThreadIndex {
+        int index = -1;
+        
+        ThreadIndex() {
+            ThreadIndices& indices = thread_indices();
+            std::lock_guard<std::mutex> lock(indices.mutex);
+            if (!indices.free.empty()) {
+                index = indices.free.back();
+                indices.free.pop_back();
+            } else if (indices.high.load(std::memory_order_relaxed) < kMaxThreads) {
+                index = indices.high.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        
+        ~ThreadIndex() {
+            if (index < 0) return;
+            ThreadIndices& indices = thread_indices();
+            std::lock_guard<std::mutex> lock(indices.mutex);
+            indices.free.push_back(index);
+        }
+    };
+    
+    static int thread_index() {
+        thread_local ThreadIndex holder;
+        return holder.index;
+    }
+    
+    std::unique_ptr<Slot[]> slots{new Slot[kMaxThreads]};
+    std::atomic<uint64_t> global_epoch{1};
+    std::mutex retire_mutex;
+    std::vector<Retired> retired;
+    std::function<void()> wake_reclaimer;
+    
+    void reclaim_locked() {
+        global_epoch.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        
+        uint64_t oldest = UINT64_MAX;
+        int high = thread_indices().high.load(std::memory_order_acquire);
+        for (int i = 0; i < high; ++i) {
+            uint64_t epoch = slots[i].epoch.load(std::memory_order_acquire);
+            if (epoch != 0 && epoch < oldest) oldest = epoch;
+        }
+        
+        auto keep = std::partition(retired.begin(), retired.end(),
+                                   [&](const Retired& item) { return item.epoch >= oldest; });
+        for (auto it = keep; it != retired.end(); ++it) {
+            it->destroy(it->object);
+        }
+        retired.erase(keep, retired.end());
+    }
+
+public:
+    ~EpochDomain() {
+        for (auto& item : retired) {
+            item.destroy(item.object);
+        }
+    }
+    
+    // Read-side critical section. inactive() means this thread has no slot
+    // and the caller must protect the read some other way.
+    class Guard {
+    private:
+        Slot* slot = nullptr;
+        bool covered = false;
+    
+    public:
+        explicit Guard(EpochDomain& domain) {
+            int index = thread_index();
+            if (index < 0) return;
+            covered = true;
+            Slot& own = domain.slots[index];
+            if (own.epoch.load(std::memory_order_relaxed) != 0) return;
+            
+            own.epoch.store(domain.global_epoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            slot = &own;
+        }
+        
+        ~Guard() {
+            if (slot) slot->epoch.store(0, std::memory_order_release);
+        }
+        
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+        
+        bool active() const {
+            return covered;
+        }
+    };
+    
+    // With a reclaimer set, a full batch wakes it instead of being freed on
+    // the retiring (writer) thread.
+    void set_reclaimer(std::function<void()> wake) {
+        std::lock_guard<std::mutex> lock(retire_mutex);
+        wake_reclaimer = std::move(wake);
+    }
+    
+    // Call only after object is unreachable for new readers.
+    template <typename T>
+    void retire(T* object) {
+        std::lock_guard<std::mutex> lock(retire_mutex);
+        retired.push_back({global_epoch.load(std::memory_order_relaxed), object,
+                           [](void* p) { delete static_cast<T*>(p); }});
+        if (retired.size() % kReclaimBatch == 0) {
+            if (wake_reclaimer) {
+                wake_reclaimer();
+            } else {
+                reclaim_locked();
+            }
+        }
+    }
+    
+    void reclaim() {
+        std::lock_guard<std::mutex> lock(retire_mutex);
+        if (!retired.empty()) reclaim_locked();
+    }
+    
+    size_t pending() {
+        std::lock_guard<std::mutex> lock(retire_mutex);
+        return retired.size();
+    }
+};
+
+// Read-only view of the keyspace for GET, EXISTS and TTL: an
+// open-addressing table of immutable entries that readers probe without any
+// lock inside an EpochDomain::Guard. Writers, serialized by data_mutex,
+// publish a fresh entry for every change and retire the one it replaces.
+// Growing the table copies only entry pointers into a new slot array.
+class ReadIndex {
+public:
+    struct Entry {
+        std::string key;
+        size_t hash = 0;
+        RedisValue::Type type = RedisValue::STRING;
+        bool has_expiry = false;
+        std::chrono::steady_clock::time_point expiry;
+        SharedValue str;
+        // Reads are recorded here rather than on the value, so an entry never
+        // keeps its RedisValue alive.
+        mutable std::atomic<uint32_t> last_access{0};
+        
+        bool is_expired() const {
+            return has_expiry && std::chrono::steady_clock::now() > expiry;
+        }
+        
+        void touch(uint32_t clock) const {
+            if (last_access.load(std::memory_order_relaxed) != clock) {
+                last_access.store(clock, std::memory_order_relaxed);
+            }
+        }
+    };
+
+private:
+    struct Table {
+        size_t mask;
+        std::unique_ptr<std::atomic<Entry*>[]> slots;
+        bool owns_entries = false;
+        
+        explicit Table(size_t capacity) : mask(capacity - 1), slots(new std::atomic<Entry*>[capacity]) {
+            for (size_t i = 0; i < capacity; ++i) {
+                slots[i].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+        
+        ~Table() {
+            if (!owns_entries) return;
+            for (size_t i = 0; i <= mask; ++i) {
+                Entry* entry = slots[i].load(std::memory_order_relaxed);
+                if (entry && entry != tombstone()) delete entry;
+            }
+        }
+    };
+    
+    static Entry* tombstone() {
+        static Entry sentinel;
+        return &sentinel;
+    }
+    
+    static size_t hash_of(const std::string& key) {
+        return std::hash<std::string>()(key);
+    }
+    
+    EpochDomain& epochs;
+    std::atomic<Table*> table;
+    size_t used = 0;
+    size_t live = 0;
+    
+    void rebuild() {
+        size_t capacity = 16;
+        while (capacity < live * 4) capacity *= 2;
+        
+        Table* old = table.load(std::memory_order_relaxed);
+        Table* fresh = new Table(capacity);
+        for (size_t i = 0; i <= old->mask; ++i) {
+            Entry* entry = old->slots[i].load(std::memory_order_relaxed);
+            if (!entry || entry == tombstone()) continue;
+            size_t j = entry->hash & fresh->mask;
+            while (fresh->slots[j].load(std::memory_order_relaxed)) {
+                j = (j + 1) & fresh->mask;
+            }
+            fresh->slots[j].store(entry, std::memory_order_relaxed);
+        }
+        table.store(fresh, std::memory_order_release);
+        used = live;
+        epochs.retire(old);
+    }
+    
+    // Writer-side probe: the slot holding key, or the null slot ending its run.
+    size_t locate(const Table* t, size_t hash, const std::string& key, size_t& reusable) const {
+        reusable = SIZE_MAX;
+        for (size_t i = hash & t->mask;; i = (i + 1) & t->mask) {
+            Entry* entry = t->slots[i].load(std::memory_order_relaxed);
+            if (!entry) return i;
+            if (entry == tombstone()) {
+                if (reusable == SIZE_MAX) reusable = i;
+            } else if (entry->hash == hash && entry->key == key) {
+                return i;
+            }
+        }
+    }
+
+public:
+    explicit ReadIndex(EpochDomain& domain) : epochs(domain), table(new Table(16)) {}
+    
+    ~ReadIndex() {
+        Table* t = table.load();
+        t->owns_entries = true;
+        delete t;
+    }
+    
+    ReadIndex(const ReadIndex&) = delete;
+    ReadIndex& operator=(const ReadIndex&) = delete;
+    
+    // Inside a guard; the entry stays valid until the guard ends.
+    const Entry* find(const std::string& key) const {
+        size_t hash = hash_of(key);
+        const Table* t = table.load(std::memory_order_acquire);
+        for (size_t i = hash & t->mask;; i = (i + 1) & t->mask) {
+            const Entry* entry = t->slots[i].load(std::memory_order_acquire);
+            if (!entry) return nullptr;
+            if (entry != tombstone() && entry->hash == hash && entry->key == key) {
+                return entry;
+            }
+        }
+    }
+    
+    // Writers only. Takes ownership of entry; on_replace sees the entry it
+    // supersedes, if any, before that one is retired.
+    template <typename Fn>
+    void publish(Entry* entry, Fn&& on_replace) {
+        entry->hash = hash_of(entry->key);
+        Table* t = table.load(std::memory_order_relaxed);
+        size_t reusable;
+        size_t i = locate(t, entry->hash, entry->key, reusable);
+        Entry* previous = t->slots[i].load(std::memory_order_relaxed);
+        if (previous) {
+            on_replace(*previous);
+            t->slots[i].store(entry, std::memory_order_release);
+            epochs.retire(previous);
+            return;
+        }
+        
+        if (reusable == SIZE_MAX) {
+            reusable = i;
+            used++;
+        }
+        t->slots[reusable].store(entry, std::memory_order_release);
+        live++;
+        if (used * 2 > t->mask + 1) rebuild();
+    }
+    
+    void publish(Entry* entry) {
+        publish(entry, [](const Entry&) {});
+    }
+    
+    bool remove(const std::string& key) {
+        Table* t = table.load(std::memory_order_relaxed);
+        size_t reusable;
+        size_t i = locate(t, hash_of(key), key, reusable);
+        Entry* previous = t->slots[i].load(std::memory_order_relaxed);
+        if (!previous) return false;
+        
+        t->slots[i].store(tombstone(), std::memory_order_release);
+        epochs.retire(previous);
+        live--;
+        return true;
+    }
+    
+    void clear() {
+        Table* old = table.load(std::memory_order_relaxed);
+        table.store(new Table(16), std::memory_order_release);
+        old->owns_entries = true;
+        used = live = 0;
+        epochs.retire(old);
+    }
+    
+    size_t size() const {
+        return live;
+    }
+};
+
+class ConnectionPool {
+private:
+    std::queue<int> available_connections;
+    std::mutex pool_mutex;
+    std::condition_variable pool_cv;
+    std::atomic<int> active_connections{0};
+    const int max_connections = 1000;
+
+public:
+    int acquire_connection() {
+        std::unique_lock<std::mutex> lock(pool_mutex);
+        if (active_connections < max_connections) {
+            active_connections++;
+            return active_connections.load();
+        }
+        return -1;
+    }
+    
+    void release_connection(int conn_id) {
+        std::unique_lock<std::mutex> lock(pool_mutex);
+        active_connections--;
+        pool_cv.notify_one();
+    }
+    
+    int get_active_count() const {
+        return active_connections.load();
+    }
+};
+
+enum CommandId {
+    CMD_SET, CMD_GET, CMD_DEL, CMD_UNLINK, CMD_EXISTS, CMD_EXPIRE, CMD_TTL,
+    CMD_LPUSH, CMD_RPUSH, CMD_LPOP, CMD_RPOP, CMD_LLEN, CMD_LRANGE,
+    CMD_HSET, CMD_HGET, CMD_HDEL, CMD_HGETALL,
+    CMD_SADD, CMD_SREM, CMD_SMEMBERS, CMD_SCARD,
+    CMD_PUBLISH, CMD_PING, CMD_INFO, CMD_FLUSHALL, CMD_FLUSHDB,
+    CMD_CONFIG, CMD_SLOWLOG, CMD_LATENCY, CMD_HOTKEYS, CMD_BIGKEYS, CMD_MONITOR,
+    CMD_CLIENT,
+    CMD_COUNT,
+    CMD_UNKNOWN = -1
+};
+
+static const char* const kCommandNames[CMD_COUNT] = {
+    "set", "get", "del", "unlink", "exists", "expire", "ttl",
+    "lpush", "rpush", "lpop", "rpop", "llen", "lrange",
+    "hset", "hget", "hdel", "hgetall",
+    "sadd", "srem", "smembers", "scard",
+    "publish", "ping", "info", "flushall", "flushdb",
+    "config", "slowlog", "latency", "hotkeys", "bigkeys", "monitor",
+    "client"
+};
+
+inline CommandId lookup_command(const std::string& upper_name) {
+    static const std::unordered_map<std::string, CommandId> ids = [] {
+        std::unordered_map<std::string, CommandId> table;
+        for (int i = 0; i < CMD_COUNT; ++i) {
+            std::string name = kCommandNames[i];
+            std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+            table[name] = static_cast<CommandId>(i);
+        }
+        return table;
+    }();
+    
+    auto it = ids.find(upper_name);
+    return it == ids.end() ? CMD_UNKNOWN : it->second;
+}
+
+// Log-linear histogram: values below 2^kSubBucketBits get exact buckets, every
+// power of two above that is split into kSubBuckets linear buckets (~12% error).
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 3;
+    static constexpr int kSubBuckets = 1 << kSubBucketBits;
+    static constexpr int kMaxValueBits = 40;
+    static constexpr int kBucketCount = (kMaxValueBits - kSubBucketBits + 1) * kSubBuckets;
+    
+    using Counts = std::array<uint64_t, kBucketCount>;
+
+private:
+    std::array<std::atomic<uint64_t>, kBucketCount> buckets{};
+
+public:
+    static int bucket_index(uint64_t value) {
+        if (value < static_cast<uint64_t>(kSubBuckets)) return static_cast<int>(value);
+        if (value >= (1ULL << kMaxValueBits)) value = (1ULL << kMaxValueBits) - 1;
+        
+        int msb = 63 - __builtin_clzll(value);
+        int shift = msb - kSubBucketBits;
+        return (shift + 1) * kSubBuckets + static_cast<int>((value >> shift) - kSubBuckets);
+    }
+    
+    static uint64_t bucket_upper_bound(int index) {
+        int group = index / kSubBuckets;
+        uint64_t sub = index % kSubBuckets;
+        if (group == 0) return sub;
+        
+        uint64_t lower = (sub + kSubBuckets) << (group - 1);
+        return lower + (1ULL << (group - 1)) - 1;
+    }
+    
+    void record(uint64_t value) {
+        buckets[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    void add_to(Counts& counts) const {
+        for (int i = 0; i < kBucketCount; ++i) {
+            counts[i] += buckets[i].load(std::memory_order_relaxed);
+        }
+    }
+    
+    static uint64_t percentile(const Counts& counts, double pct) {
+        uint64_t total = 0;
+        for (uint64_t c : counts) total += c;
+        if (total == 0) return 0;
+        
+        uint64_t rank = static_cast<uint64_t>(pct / 100.0 * total + 0.5);
+        if (rank == 0) rank = 1;
+        
+        uint64_t seen = 0;
+        for (int i = 0; i < kBucketCount; ++i) {
+            seen += counts[i];
+            if (seen >= rank) return bucket_upper_bound(i);
+        }
+        return bucket_upper_bound(kBucketCount - 1);
+    }
+};
+
+struct CommandCounters {
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> total_ns{0};
+    LatencyHistogram latency_ns;
+};
+
+struct SlowlogEntry {
+    uint64_t id;
+    int64_t timestamp;
+    uint64_t duration_us;
+    std::vector<std::string> args;
+    std::string client_addr;
+};
+
+// Per-thread slice of the slow log. The mutex is only ever contended by SLOWLOG
+// readers, never by other connection threads.
+class SlowlogRing {
+private:
+    std::mutex ring_mutex;
+    std::deque<SlowlogEntry> entries;
+
+public:
+    void push(SlowlogEntry&& entry, size_t max_len) {
+        std::lock_guard<std::mutex> lock(ring_mutex);
+        entries.push_back(std::move(entry));
+        while (entries.size() > max_len) {
+            entries.pop_front();
+        }
+    }
+    
+    void collect(std::vector<SlowlogEntry>& out) {
+        std::lock_guard<std::mutex> lock(ring_mutex);
+        out.insert(out.end(), entries.begin(), entries.end());
+    }
+    
+    size_t size() {
+        std::lock_guard<std::mutex> lock(ring_mutex);
+        return entries.size();
+    }
+    
+    void clear() {
+        std::lock_guard<std::mutex> lock(ring_mutex);
+        entries.clear();
+    }
+};
+
+// Count-min sketch over sampled key accesses plus the top-K keys seen by one
+// thread. Only the owning thread writes the counters; decay halves them (LFU
+// style) whenever the server-wide decay epoch moves past the local one.
+class HotKeySketch {
+public:
+    static constexpr int kDepth = 4;
+    static constexpr int kWidth = 2048;
+    static constexpr size_t kTopK = 32;
+
+private:
+    std::array<std::atomic<uint32_t>, kDepth * kWidth> counters{};
+    std::mutex top_mutex;
+    std::vector<std::pair<std::string, uint32_t>> top;
+    std::atomic<uint64_t> decay_epoch{0};
+    
+    void decay(uint64_t halvings) {
+        int shift = static_cast<int>(std::min<uint64_t>(halvings, 31));
+        for (auto& counter : counters) {
+            counter.store(counter.load(std::memory_order_relaxed) >> shift, std::memory_order_relaxed);
+        }
+        
+        std::lock_guard<std::mutex> lock(top_mutex);
+        for (auto& entry : top) {
+            entry.second >>= shift;
+        }
+        top.erase(std::remove_if(top.begin(), top.end(),
+                                 [](const std::pair<std::string, uint32_t>& entry) { return entry.second == 0; }),
+                  top.end());
+    }
+
+public:
+    void record(const std::string& key, uint64_t global_epoch) {
+        uint64_t local_epoch = decay_epoch.load(std::memory_order_relaxed);
+        if (local_epoch != global_epoch) {
+            decay(global_epoch - local_epoch);
+            decay_epoch.store(global_epoch, std::memory_order_relaxed);
+        }
+        
+        size_t hash = std::hash<std::string>{}(key);
+        uint32_t h1 = static_cast<uint32_t>(hash);
+        uint32_t h2 = static_cast<uint32_t>(hash >> 32) | 1;
+        
+        // Conservative update: only the smallest counters are incremented.
+        std::atomic<uint32_t>* cells[kDepth];
+        uint32_t estimate = UINT32_MAX;
+        for (int row = 0; row < kDepth; ++row) {
+            cells[row] = &counters[row * kWidth + (h1 + row * h2) % kWidth];
+            estimate = std::min(estimate, cells[row]->load(std::memory_order_relaxed));
+        }
+        estimate++;
+        for (int row = 0; row < kDepth; ++row) {
+            if (cells[row]->load(std::memory_order_relaxed) < estimate) {
+                cells[row]->store(estimate, std::memory_order_relaxed);
+            }
+        }
+        
+        std::lock_guard<std::mutex> lock(top_mutex);
+        auto smallest = top.end();
+        for (auto it = top.begin(); it != top.end(); ++it) {
+            if (it->first == key) {
+                it->second = estimate;
+                return;
+            }
+            if (smallest == top.end() || it->second < smallest->second) {
+                smallest = it;
+            }
+        }
+        
+        if (top.size() < kTopK) {
+            top.emplace_back(key, estimate);
+        } else if (estimate > smallest->second) {
+            *smallest = {key, estimate};
+        }
+    }
+    
+    // Idle threads decay lazily, so scale their counts by the epochs they missed.
+    void collect(std::unordered_map<std::string, uint64_t>& out, uint64_t global_epoch) {
+        uint64_t missed = global_epoch - decay_epoch.load(std::memory_order_relaxed);
+        if (missed >= 32) return;
+        
+        std::lock_guard<std::mutex> lock(top_mutex);
+        for (const auto& entry : top) {
+            uint64_t count = entry.second >> missed;
+            if (count > 0) out[entry.first] += count;
+        }
+    }
+};
+
+// Single-producer/single-consumer ring of commands seen by one connection
+// thread while MONITOR is active. The owning thread copies the arguments in;
+// the monitor drain thread is the only consumer. The slot array is allocated
+// on first use so idle threads pay nothing for it.
+class MonitorRing {
+public:
+    static constexpr size_t kCapacity = 256;
+    
+    struct Record {
+        uint64_t sequence;
+        int64_t timestamp_us;
+        std::vector<std::string> args;
+        std::string client_addr;
+    };
+
+private:
+    std::unique_ptr<Record[]> records;
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+
+public:
+    bool push(uint64_t sequence, int64_t timestamp_us, const std::vector<std::string>& args, const std::string& client_addr) {
+        size_t position = head.load(std::memory_order_relaxed);
+        if (position - tail.load(std::memory_order_acquire) >= kCapacity) return false;
+        
+        if (!records) records.reset(new Record[kCapacity]);
+        Record& record = records[position % kCapacity];
+        record.sequence = sequence;
+        record.timestamp_us = timestamp_us;
+        record.args.assign(args.begin(), args.end());
+        record.client_addr = client_addr;
+        
+        head.store(position + 1, std::memory_order_release);
+        return true;
+    }
+    
+    template <typename Fn>
+    size_t drain(Fn&& fn) {
+        size_t position = tail.load(std::memory_order_relaxed);
+        size_t end = head.load(std::memory_order_acquire);
+        for (size_t i = position; i != end; ++i) {
+            fn(records[i % kCapacity]);
+        }
+        tail.store(end, std::memory_order_release);
+        return end - position;
+    }
+};
+
+enum LockId { LOCK_KEYSPACE, LOCK_PUBSUB, LOCK_COUNT };
+
+static const char* const kLockNames[LOCK_COUNT] = {"keyspace", "pubsub"};
+
+// Wait/hold statistics for one lock as seen by one thread, broken down by the
+// command being executed. Threads outside a command (expiry sweep, analyzer)
+// are counted under the extra "background" caller slot.
+struct LockCounters {
+    static constexpr int kCallers = CMD_COUNT + 1;
+    
+    std::atomic<uint64_t> acquisitions{0};
+    std::atomic<uint64_t> contended{0};
+    std::atomic<uint64_t> wait_ns{0};
+    std::atomic<uint64_t> hold_ns{0};
+    LatencyHistogram wait_hist;
+    LatencyHistogram hold_hist;
+    std::array<std::atomic<uint64_t>, kCallers> caller_acquisitions{};
+    std::array<std::atomic<uint64_t>, kCallers> caller_wait_ns{};
+    std::array<std::atomic<uint64_t>, kCallers> caller_hold_ns{};
+};
+
+class LockProfileSlot {
+private:
+    std::array<std::atomic<LockCounters*>, LOCK_COUNT> locks{};
+
+public:
+    ~LockProfileSlot() {
+        for (auto& counters : locks) {
+            delete counters.load();
+        }
+    }
+    
+    LockCounters& counters(LockId id) {
+        LockCounters* counters = locks[id].load(std::memory_order_acquire);
+        if (!counters) {
+            auto* fresh = new LockCounters();
+            if (locks[id].compare_exchange_strong(counters, fresh, std::memory_order_acq_rel)) {
+                counters = fresh;
+            } else {
+                delete fresh;
+            }
+        }
+        return *counters;
+    }
+    
+    const LockCounters* find(LockId id) const {
+        return locks[id].load(std::memory_order_acquire);
+    }
+};
+
+inline thread_local LockProfileSlot* tls_lock_profile = nullptr;
+inline thread_local int tls_current_command = CMD_COUNT;
+
+inline int64_t steady_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Drop-in std::shared_mutex replacement. With profiling off it costs one
+// relaxed load per operation; with it on, uncontended acquisitions are taken
+// with try_lock first so only real waits pay for clock reads.
+class ProfiledSharedMutex {
+private:
+#ifdef REDIS_CLONE_USDT
+    static constexpr bool kAlwaysTimeWaits = true;
+#else
+    static constexpr bool kAlwaysTimeWaits = false;
+#endif
+    
+    std::shared_mutex mutex;
+    LockId id;
+    const std::atomic<bool>* enabled = nullptr;
+    LockProfileSlot* fallback = nullptr;
+    int64_t exclusive_since_ns = 0;
+    static thread_local std::array<int64_t, LOCK_COUNT> shared_since_ns;
+    
+    bool profiling() const {
+        return enabled && enabled->load(std::memory_order_relaxed);
+    }
+    
+    LockCounters* counters() {
+        LockProfileSlot* slot = tls_lock_profile ? tls_lock_profile : fallback;
+        return slot ? &slot->counters(id) : nullptr;
+    }
+    
+    template <typename TryFn, typename LockFn>
+    int64_t acquire(TryFn&& try_acquire, LockFn&& block) {
+        bool profile = profiling();
+        if (!profile && !kAlwaysTimeWaits) {
+            block();
+            return 0;
+        }
+        
+        uint64_t wait_ns = 0;
+        bool contended = !try_acquire();
+        if (contended) {
+            int64_t start = steady_now_ns();
+            block();
+            wait_ns = steady_now_ns() - start;
+            TRACE_PROBE2(lock__wait, kLockNames[id], wait_ns);
+        }
+        if (!profile) return 0;
+        
+        LockCounters* stats = counters();
+        if (!stats) return 0;
+        stats->acquisitions.fetch_add(1, std::memory_order_relaxed);
+        stats->caller_acquisitions[tls_current_command].fetch_add(1, std::memory_order_relaxed);
+        if (contended) {
+            stats->contended.fetch_add(1, std::memory_order_relaxed);
+            stats->wait_ns.fetch_add(wait_ns, std::memory_order_relaxed);
+            stats->caller_wait_ns[tls_current_command].fetch_add(wait_ns, std::memory_order_relaxed);
+        }
+        stats->wait_hist.record(wait_ns);
+        return steady_now_ns();
+    }
+    
+    void record_hold(int64_t since_ns) {
+        if (since_ns == 0) return;
+        LockCounters* stats = counters();
+        if (!stats) return;
+        
+        uint64_t hold_ns = steady_now_ns() - since_ns;
+        stats->hold_ns.fetch_add(hold_ns, std::memory_order_relaxed);
+        stats->caller_hold_ns[tls_current_command].fetch_add(hold_ns, std::memory_order_relaxed);
+        stats->hold_hist.record(hold_ns);
+    }
+
+public:
+    explicit ProfiledSharedMutex(LockId lock_id) : id(lock_id) {}
+    
+    void attach_profiler(const std::atomic<bool>* profiling_enabled, LockProfileSlot* fallback_slot) {
+        enabled = profiling_enabled;
+        fallback = fallback_slot;
+    }
+    
+    void lock() {
+        exclusive_since_ns = acquire([this] { return mutex.try_lock(); }, [this] { mutex.lock(); });
+    }
+    
+    bool try_lock() {
+        if (!mutex.try_lock()) return false;
+        exclusive_since_ns = 0;
+        return true;
+    }
+    
+    void unlock() {
+        int64_t since = exclusive_since_ns;
+        mutex.unlock();
+        record_hold(since);
+    }
+    
+    void lock_shared() {
+        shared_since_ns[id] = acquire([this] { return mutex.try_lock_shared(); }, [this] { mutex.lock_shared(); });
+    }
+    
+    bool try_lock_shared() {
+        if (!mutex.try_lock_shared()) return false;
+        shared_since_ns[id] = 0;
+        return true;
+    }
+    
+    void unlock_shared() {
+        int64_t since = shared_since_ns[id];
+        mutex.unlock_shared();
+        record_hold(since);
+    }
+};
+
+// The connection currently served by a worker thread. Counters are written
+// only by that thread; CLIENT LIST reads them without blocking it. The mutex
+// guards the strings and the fd against a concurrent CLIENT KILL.
+struct ClientInfo {
+    std::mutex info_mutex;
+    bool active = false;
+    int fd = -1;
+    std::string addr;
+    std::string name;
+    int64_t created_at = 0;
+    
+    std::atomic<uint64_t> id{0};
+    std::atomic<int64_t> last_interaction_ns{0};
+    std::atomic<uint64_t> net_input_bytes{0};
+    std::atomic<uint64_t> net_output_bytes{0};
+    std::atomic<uint64_t> commands{0};
+    std::atomic<uint64_t> query_buffer{0};
+    std::atomic<uint64_t> output_buffer{0};
+    std::atomic<int> current_command{CMD_COUNT};
+    std::atomic<bool> killed{false};
+};
+
+// A shared value spliced into a reply without copying. Its bytes go on the
+// wire just before reply_buffer[offset].
+struct ReplyRef {
+    size_t offset;
+    SharedValue value;
+};
+
+// Values sent with MSG_ZEROCOPY, kept alive until the socket's error queue
+// reports the kernel is done with their pages.
+struct ZeroCopyPins {
+    bool enabled = false;
+    bool unsupported = false;
+    uint32_t next_id = 0;
+    std::deque<std::pair<uint32_t, SharedValue>> pending;
+};
+
+// Statistics owned by one connection thread. Only the owner writes to them (the
+// shared fallback slot aside), so updates are uncontended relaxed atomics and
+// readers such as INFO aggregate across slots without stopping anyone.
+class WorkerStats {
+private:
+    std::array<std::atomic<CommandCounters*>, CMD_COUNT> commands{};
+
+public:
+    SlowlogRing slowlog;
+    HotKeySketch hotkeys;
+    uint32_t hotkey_countdown = 0;
+    MonitorRing monitor;
+    uint64_t monitor_sequence = 0;
+    LockProfileSlot locks;
+    ClientInfo client;
+    std::atomic<uint64_t> net_input_bytes{0};
+    std::atomic<uint64_t> net_output_bytes{0};
+    
+    // Reply buffer of the connection owning this slot. Slots are recycled,
+    // so its capacity carries over to the next connection instead of being
+    // regrown from empty.
+    std::string reply_buffer;
+    std::vector<ReplyRef> reply_refs;
+    static constexpr size_t kReplyBufferKeep = 1 << 20;
+    
+    ~WorkerStats() {
+        for (auto& counters : commands) {
+            delete counters.load();
+        }
+    }
+    
+    void record_command(CommandId id, uint64_t elapsed_ns) {
+        CommandCounters* counters = commands[id].load(std::memory_order_acquire);
+        if (!counters) {
+            auto* fresh = new CommandCounters();
+            if (commands[id].compare_exchange_strong(counters, fresh, std::memory_order_acq_rel)) {
+                counters = fresh;
+            } else {
+                delete fresh;
+            }
+        }
+        
+        counters->calls.fetch_add(1, std::memory_order_relaxed);
+        counters->total_ns.fetch_add(elapsed_ns, std::memory_order_relaxed);
+        counters->latency_ns.record(elapsed_ns);
+    }
+    
+    const CommandCounters* command(CommandId id) const {
+        return commands[id].load(std::memory_order_acquire);
+    }
+};
+
+// Slots are recycled rather than freed when a connection thread exits, so the
+// counters they hold stay cumulative for the lifetime of the server.
+template <typename T>
+class ThreadSlotRegistry {
+private:
+    std::mutex registry_mutex;
+    std::vector<std::unique_ptr<T>> slots;
+    std::vector<T*> free_slots;
+
+public:
+    T* acquire() {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        if (!free_slots.empty()) {
+            T* slot = free_slots.back();
+            free_slots.pop_back();
+            return slot;
+        }
+        slots.push_back(std::make_unique<T>());
+        return slots.back().get();
+    }
+    
+    void release(T* slot) {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        free_slots.push_back(slot);
+    }
+    
+    template <typename Fn>
+    void for_each(Fn&& fn) {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        for (auto& slot : slots) {
+            fn(*slot);
+        }
+    }
+};
+
+class PubSubManager {
+private:
+    std::unordered_map<std::string, std::vector<int>> channel_subscribers;
+    ProfiledSharedMutex pubsub_mutex{LOCK_PUBSUB};
+
+public:
+    ProfiledSharedMutex& mutex() {
+        return pubsub_mutex;
+    }
+    
+    void subscribe(const std::string& channel, int client_fd) {
+        std::unique_lock<ProfiledSharedMutex> lock(pubsub_mutex);
+        channel_subscribers[channel].push_back(client_fd);
+    }
+    
+    void unsubscribe(const std::string& channel, int client_fd) {
+        std::unique_lock<ProfiledSharedMutex> lock(pubsub_mutex);
+        auto& subscribers = channel_subscribers[channel];
+        subscribers.erase(std::remove(subscribers.begin(), subscribers.end(), client_fd), subscribers.end());
+    }
+    
+    int publish(const std::string& channel, const std::string& message) {
+        std::shared_lock<ProfiledSharedMutex> lock(pubsub_mutex);
+        auto it = channel_subscribers.find(channel);
+        if (it == channel_subscribers.end()) return 0;
+        
+        int count = 0;
+        std::string response = "*3\r\n$7\r\nmessage\r\n$" + std::to_string(channel.length()) + 
+                              "\r\n" + channel + "\r\n$" + std::to_string(message.length()) + 
+                              "\r\n" + message + "\r\n";
+        
+        for (int fd : it->second) {
+            if (send(fd, response.c_str(), response.length(), MSG_NOSIGNAL) > 0) {
+                count++;
+            }
+        }
+        return count;
+    }
+};
+
+struct LatencySample {
+    int64_t timestamp;
+    uint64_t latency_ms;
+};
+
+// Keeps the last kHistoryLen spikes of each internal event, one sample per
+// second (the worst one). Only events above the threshold reach this class, so
+// a plain mutex is fine here.
+class LatencyMonitor {
+public:
+    static constexpr size_t kHistoryLen = 160;
+    
+    struct EventHistory {
+        std::deque<LatencySample> samples;
+        uint64_t max_ms = 0;
+    };
+
+private:
+    std::mutex monitor_mutex;
+    std::map<std::string, EventHistory> events;
+
+public:
+    void add_sample(const std::string& event, uint64_t latency_ms) {
+        int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        
+        std::lock_guard<std::mutex> lock(monitor_mutex);
+        EventHistory& history = events[event];
+        history.max_ms = std::max(history.max_ms, latency_ms);
+        
+        if (!history.samples.empty() && history.samples.back().timestamp == now) {
+            history.samples.back().latency_ms = std::max(history.samples.back().latency_ms, latency_ms);
+            return;
+        }
+        
+        history.samples.push_back({now, latency_ms});
+        if (history.samples.size() > kHistoryLen) {
+            history.samples.pop_front();
+        }
+    }
+    
+    std::map<std::string, EventHistory> snapshot() {
+        std::lock_guard<std::mutex> lock(monitor_mutex);
+        return events;
+    }
+    
+    size_t reset(const std::vector<std::string>& names) {
+        std::lock_guard<std::mutex> lock(monitor_mutex);
+        if (names.empty()) {
+            size_t count = events.size();
+            events.clear();
+            return count;
+        }
+        
+        size_t count = 0;
+        for (const auto& name : names) {
+            count += events.erase(name);
+        }
+        return count;
+    }
+};
+
+struct KeySizeInfo {
+    std::string key;
+    uint64_t elements;
+    uint64_t bytes;
+};
+
+// Results of one background keyspace analysis run. The analyzer thread works
+// on a private copy and publishes it after every batch.
+struct KeyspaceReport {
+    static constexpr size_t kTopKeys = 5;
+    static constexpr int kTypeCount = 4;
+    static constexpr int kTtlBuckets = 5;
+    
+    std::string status = "idle";
+    std::string mode;
+    int64_t started_at = 0;
+    int64_t finished_at = 0;
+    uint64_t buckets_scanned = 0;
+    uint64_t buckets_total = 0;
+    uint64_t keys_scanned = 0;
+    std::array<uint64_t, kTypeCount> type_keys{};
+    std::array<uint64_t, kTypeCount> type_bytes{};
+    std::array<std::vector<KeySizeInfo>, kTypeCount> largest_by_elements;
+    std::array<std::vector<KeySizeInfo>, kTypeCount> largest_by_bytes;
+    std::map<std::string, uint64_t> encodings;
+    std::array<uint64_t, kTtlBuckets> ttl_histogram{};
+    
+    static const char* type_name(int type) {
+        static const char* const names[kTypeCount] = {"string", "list", "hash", "set"};
+        return names[type];
+    }
+    
+    static const char* ttl_bucket_name(int bucket) {
+        static const char* const names[kTtlBuckets] = {"no_ttl", "lt_1m", "lt_1h", "lt_1d", "ge_1d"};
+        return names[bucket];
+    }
+    
+    static void offer(std::vector<KeySizeInfo>& top, const KeySizeInfo& info, uint64_t KeySizeInfo::*field) {
+        if (top.size() == kTopKeys && top.back().*field >= info.*field) return;
+        
+        auto pos = std::find_if(top.begin(), top.end(),
+                                [&](const KeySizeInfo& other) { return other.*field < info.*field; });
+        top.insert(pos, info);
+        if (top.size() > kTopKeys) top.pop_back();
+    }
+};
+
+inline std::string format_fixed(double value, int precision) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.*f", precision, value);
+    return buffer;
+}
+
+inline uint64_t read_rss_bytes() {
+#ifdef __linux__
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (!statm) return 0;
+    
+    unsigned long size = 0, resident = 0;
+    int fields = fscanf(statm, "%lu %lu", &size, &resident);
+    fclose(statm);
+    return fields == 2 ? static_cast<uint64_t>(resident) * sysconf(_SC_PAGESIZE) : 0;
+#else
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<uint64_t>(usage.ru_maxrss);
+#endif
+}
+
+class RedisClone {
+private:
+    using Keyspace = std::unordered_map<std::string, std::shared_ptr<RedisValue>>;
+    Keyspace data;
+    mutable ProfiledSharedMutex data_mutex{LOCK_KEYSPACE};
+    
+    // GET, EXISTS and TTL read this instead of data and never take
+    // data_mutex. Writers keep it in step with data under the exclusive lock
+    // through publish_key/erase_key. Hash fields are not indexed: one entry
+    // per field would copy every key, field and value and double the cost
+    // of hash writes, so HGET stays on the shared lock.
+    EpochDomain read_epochs;
+    ReadIndex key_index{read_epochs};
+    
+    // Protects a lookup in the read indexes: an epoch guard, or the shared
+    // lock for a thread beyond EpochDomain::kMaxThreads.
+    struct ReadSection {
+        EpochDomain::Guard guard;
+        std::shared_lock<ProfiledSharedMutex> fallback;
+        
+        explicit ReadSection(RedisClone& server) : guard(server.read_epochs), fallback(server.data_mutex, std::defer_lock) {
+            if (!guard.active()) fallback.lock();
+        }
+    };
+    ConnectionPool connection_pool;
+    PubSubManager pubsub_manager;
+    std::atomic<bool> running{true};
+    std::thread cleanup_thread;
+    std::atomic<uint64_t> total_connections_received{0};
+    std::atomic<uint64_t> next_client_id{1};
+    
+    // Published by the expiry sweep once per second so that readers outside
+    // the keyspace (the metrics endpoint) never need data_mutex.
+    std::atomic<uint64_t> keyspace_keys{0};
+    std::atomic<uint64_t> keyspace_expires{0};
+    std::atomic<uint64_t> expired_keys_total{0};
+    std::atomic<uint64_t> expire_cycles_total{0};
+    std::atomic<uint64_t> expire_cycle_last_ns{0};
+    
+    int metrics_port = 0;
+    std::atomic<int> metrics_fd{-1};
+    std::thread metrics_thread;
+    ThreadSlotRegistry<WorkerStats> worker_stats;
+    WorkerStats shared_worker_stats;
+    static thread_local WorkerStats* tls_worker_stats;
+    static thread_local std::string tls_client_addr;
+    static thread_local int tls_client_fd;
+    static thread_local std::vector<ReplyRef>* tls_reply_refs;
+    static thread_local bool tls_monitoring;
+    
+    // Everything written to a monitor connection, its own replies included,
+    // goes through pending and is sent by the drain thread, so partial
+    // writes resume where they stopped and records are dropped only whole.
+    // Each monitor keeps its own SAMPLE rate: connection threads number
+    // their commands and record those divisible by monitor_sample_stride,
+    // the gcd of all rates, and a monitor with rate n takes the records
+    // whose number is divisible by n.
+    struct MonitorClient {
+        int fd;
+        std::string prefix;
+        uint32_t sample_rate;
+        std::string pending;
+    };
+    static constexpr size_t kMonitorMaxPending = 1024 * 1024;
+    
+    std::mutex monitor_mutex;
+    std::vector<MonitorClient> monitor_clients;
+    std::thread monitor_thread;
+    bool monitor_drain_running = false;
+    std::atomic<bool> monitor_active{false};
+    std::atomic<uint32_t> monitor_sample_stride{1};
+    std::atomic<uint64_t> monitor_dropped{0};
+    
+    static constexpr size_t kSlowlogMaxArgs = 32;
+    static constexpr size_t kSlowlogMaxArgLen = 128;
+    std::atomic<long long> slowlog_slower_than{10000};
+    std::atomic<size_t> slowlog_max_len{128};
+    std::atomic<uint64_t> slowlog_next_id{0};
+    
+    std::mutex analysis_mutex;
+    KeyspaceReport analysis_report;
+    std::thread analysis_thread;
+    std::atomic<bool> analysis_running{false};
+    
+    std::atomic<bool> lock_profiling{false};
+    
+    std::atomic<uint32_t> hotkeys_sample_rate{8};
+    std::atomic<uint64_t> hotkeys_decay_epoch{0};
+    std::atomic<uint32_t> hotkeys_decay_seconds{60};
+    
+    LatencyMonitor latency_monitor;
+    std::atomic<uint64_t> latency_threshold_ms{0};
+    
+    // Once the keyspace holds maxkeys keys, inserting a new key first evicts
+    // one picked by the policy from kEvictionSamples random keys.
+    enum EvictionPolicy { EVICT_NONE, EVICT_ALLKEYS_LRU, EVICT_ALLKEYS_RANDOM };
+    static constexpr const char* kEvictionPolicyNames[] = {"noeviction", "allkeys-lru", "allkeys-random"};
+    static constexpr const char* kOomError = "OOM command not allowed when used keys > 'maxkeys'";
+    static constexpr int kEvictionSamples = 5;
+    std::atomic<uint64_t> maxkeys{0};
+    std::atomic<int> eviction_policy{EVICT_NONE};
+    std::atomic<uint64_t> evicted_keys_total{0};
+    std::atomic<uint32_t> lru_clock{0};
+    
+    // Values detached from the keyspace by UNLINK, FLUSHALL/FLUSHDB ASYNC or
+    // the lazyfree-lazy-* options are destroyed on lazyfree_thread, off
+    // data_mutex. Only values with more than kLazyFreeThreshold elements go
+    // there; freeing anything smaller inline is cheaper than the handoff.
+    // The same thread runs epoch reclamation for the read indexes.
+    static constexpr size_t kLazyFreeThreshold = 64;
+    std::thread lazyfree_thread;
+    std::mutex lazyfree_mutex;
+    std::condition_variable lazyfree_cv;
+    std::vector<std::shared_ptr<RedisValue>> lazyfree_values;
+    std::vector<std::unique_ptr<Keyspace>> lazyfree_keyspaces;
+    bool lazyfree_reclaim = false;
+    std::atomic<uint64_t> lazyfree_pending_objects{0};
+    std::atomic<uint64_t> lazyfreed_objects_total{0};
+    std::atomic<bool> lazyfree_user_del{false};
+    std::atomic<bool> lazyfree_expire{false};
+    std::atomic<bool> lazyfree_eviction{false};
+    
+    // Connections closed while zero-copy sends were still in flight. The fd
+    // is shut down both ways but stays open so its error queue can be read,
+    // and lazyfree_thread drops the pins and closes it once the kernel
+    // reports every send complete. A peer that stops reading would hold them
+    // forever, so after kZeroCopyOrphanTimeout the connection is reset, which
+    // purges the kernel's send queue, and the pins go after a short grace.
+    struct ZeroCopyOrphan {
+        int fd;
+        ZeroCopyPins pins;
+        std::chrono::steady_clock::time_point deadline;
+        bool reset = false;
+    };
+    static constexpr std::chrono::seconds kZeroCopyOrphanTimeout{30};
+    static constexpr std::chrono::seconds kZeroCopyResetGrace{1};
+    std::mutex zerocopy_orphans_mutex;
+    std::vector<ZeroCopyOrphan> zerocopy_orphans;
+    
+    // GET on a connection splices values at least kReplySpliceMin long into
+    // the reply by reference. Those at least zerocopy_threshold long are sent
+    // with MSG_ZEROCOPY; 0 turns zero-copy sends off.
+    static constexpr size_t kReplySpliceMin = 16 * 1024;
+    std::atomic<uint64_t> zerocopy_threshold{0};
+    
+    void record_latency_event(const char* event, std::chrono::steady_clock::duration elapsed);
+    
+    // Inserts under an exclusive data_mutex, timing the insert as a "rehash"
+    // event whenever it is going to grow the bucket array. Returns false if
+    // the key is new, the keyspace is full and the policy is noeviction.
+    // Every removal from data goes through erase_key so the read indexes
+    // follow; lazy hands a large value to lazyfree_thread.
+    bool insert_key(const std::string& key, std::shared_ptr<RedisValue> value);
+    Keyspace::iterator erase_key(Keyspace::iterator it, bool lazy = false);
+    static size_t free_effort(const RedisValue& value);
+    void lazyfree_loop();
+    void wake_lazyfree();
+    void publish_key(const std::string& key, const std::shared_ptr<RedisValue>& value);
+    bool evict_keys(uint64_t count);
+    void cleanup_expired_keys();
+    
+    // Lookups for the typed API, under data_mutex. Both count as an access.
+    // find_live returns null for missing, expired or other-typed keys;
+    // find_or_create returns null for other-typed keys or a full keyspace.
+    RedisValue* find_live(const std::string& key, RedisValue::Type type);
+    RedisValue* find_or_create(const std::string& key, RedisValue::Type type);
+    
+    void process_command(const std::vector<std::string>& tokens, std::string& out);
+    void dispatch_command(CommandId id, const std::vector<std::string>& tokens, std::string& out);
+    void sample_hot_key(WorkerStats* stats, const std::string& key);
+    WorkerStats* current_worker_stats();
+    
+    void handle_set(const std::vector<std::string>& tokens, std::string& out);
+    void handle_get(const std::vector<std::string>& tokens, std::string& out);
+    void handle_del(const std::vector<std::string>& tokens, std::string& out, bool unlink);
+    void handle_exists(const std::vector<std::string>& tokens, std::string& out);
+    void handle_expire(const std::vector<std::string>& tokens, std::string& out);
+    void handle_ttl(const std::vector<std::string>& tokens, std::string& out);
+    void handle_lpush(const std::vector<std::string>& tokens, std::string& out);
+    void handle_rpush(const std::vector<std::string>& tokens, std::string& out);
+    void handle_lpop(const std::vector<std::string>& tokens, std::string& out);
+    void handle_rpop(const std::vector<std::string>& tokens, std::string& out);
+    void handle_llen(const std::vector<std::string>& tokens, std::string& out);
+    void handle_lrange(const std::vector<std::string>& tokens, std::string& out);
+    void handle_hset(const std::vector<std::string>& tokens, std::string& out);
+    void handle_hget(const std::vector<std::string>& tokens, std::string& out);
+    void handle_hdel(const std::vector<std::string>& tokens, std::string& out);
+    void handle_hgetall(const std::vector<std::string>& tokens, std::string& out);
+    void handle_sadd(const std::vector<std::string>& tokens, std::string& out);
+    void handle_srem(const std::vector<std::string>& tokens, std::string& out);
+    void handle_smembers(const std::vector<std::string>& tokens, std::string& out);
+    void handle_scard(const std::vector<std::string>& tokens, std::string& out);
+    std::string handle_publish(const std::vector<std::string>& tokens);
+    std::string handle_flushall(const std::vector<std::string>& tokens);
+    
+    std::string handle_info(const std::vector<std::string>& tokens);
+    std::array<LatencyHistogram::Counts, CMD_COUNT> collect_command_histograms(
+            std::array<uint64_t, CMD_COUNT>& calls, std::array<uint64_t, CMD_COUNT>& total_ns);
+    std::string info_stats();
+    std::string info_lockstats();
+    std::string info_commandstats();
+    std::string info_latencystats();
+    std::string info_keyspace_analysis();
+    
+    void record_slowlog(WorkerStats* stats, const std::vector<std::string>& tokens, uint64_t duration_us);
+    std::string handle_slowlog(const std::vector<std::string>& tokens);
+    std::string handle_latency(const std::vector<std::string>& tokens);
+    std::string latency_doctor_report();
+    std::string handle_hotkeys(const std::vector<std::string>& tokens);
+    std::string handle_config(const std::vector<std::string>& tokens);
+    std::string handle_client_command(const std::vector<std::string>& tokens);
+    std::string format_client_info(ClientInfo& client, int64_t now_ns);
+    
+    template <typename Fn>
+    void for_each_worker_stats(Fn&& fn) {
+        worker_stats.for_each(fn);
+        fn(shared_worker_stats);
+    }
+    
+    // Element counts are exact; byte sizes of collections are extrapolated from
+    // at most kSizeSamples elements so that huge keys don't stretch a batch.
+    static KeySizeInfo measure_key(const std::string& key, const RedisValue& value, std::string& encoding);
+    
+    // Walks the keyspace bucket by bucket, holding the shared lock for at most
+    // batch_keys keys at a time. A rehash between batches rescales the cursor,
+    // so a few keys may be missed or counted twice; the report is approximate.
+    void analyze_keyspace(size_t sample_stride, size_t batch_keys, uint32_t sleep_usec);
+    std::string handle_bigkeys(const std::vector<std::string>& tokens);
+    std::string keyspace_analysis_report();
+    
+    void feed_monitor(WorkerStats* stats, const std::vector<std::string>& tokens);
+    static std::string format_monitor_record(const MonitorRing::Record& record);
+    std::string handle_monitor(const std::vector<std::string>& tokens);
+    
+    // Prometheus text exposition. Everything here comes from atomics and the
+    // per-thread stats slots; nothing takes data_mutex.
+    std::string render_metrics();
+    
+    // Networking (redis_server.cpp).
+    
+    // The single consumer of every thread's MonitorRing. Formatting and
+    // socket writes happen here, off the command path; the thread exits once
+    // the last monitor disconnects.
+    void drain_monitors();
+    void remove_monitor(int client_fd);
+    void update_monitor_stride();
+    static void flush_monitor(MonitorClient& client);
+    bool queue_monitor_reply(int client_fd, const std::string& output);
+    void serve_metrics(int server_fd);
+    void start_metrics_server();
+    void open_client_info(ClientInfo& info, int client_fd, const std::string& client_addr);
+    
+    // Writes the reply buffer with each ReplyRef's value spliced in at its
+    // offset. Returns the bytes sent, or -1 if the connection failed.
+    ssize_t send_reply(int client_fd, const std::string& output, const std::vector<ReplyRef>& refs, ZeroCopyPins& pins);
+    void close_client(int client_fd, ZeroCopyPins& pins);
+    void reap_zerocopy_orphans();
+
+public:
+    RedisClone();
+    ~RedisClone();
+    
+    static const std::vector<std::string>& config_names();
+    std::string config_get(const std::string& name);
+    std::string config_set(const std::string& name, const std::string& value);
+    
+    // Embedding API. Runs one command against this engine and returns its
+    // RESP reply, exactly as a network client would see it. Safe to call from
+    // any thread; calls from threads the server did not start share one stats
+    // slot.
+    std::string execute(const std::vector<std::string>& args);
+    std::string execute(size_t argc, const char* const* argv, const size_t* argv_len);
+    
+    // One full pass over the keyspace under the exclusive lock. Returns the
+    // number of keys removed. The housekeeping thread runs it once a second.
+    uint64_t expire_sweep();
+    
+    // Typed embedding API (redis_embedded.cpp): the same keyspace, locking,
+    // expiry and eviction as the commands, without RESP. Results go into
+    // caller-owned buffers so a loop can reuse them. Reads of a key holding
+    // another type behave as a miss; writes to one fail (false or -1).
+    // These calls skip command stats, SLOWLOG and MONITOR.
+    bool set(const std::string& key, const std::string& value, int ttl_seconds = 0);
+    bool get(const std::string& key, std::string& value);
+    bool del(const std::string& key);
+    bool exists(const std::string& key);
+    bool expire(const std::string& key, int seconds);
+    long long ttl(const std::string& key);
+    
+    long long hset(const std::string& key, const std::string& field, const std::string& value);
+    bool hget(const std::string& key, const std::string& field, std::string& value);
+    bool hdel(const std::string& key, const std::string& field);
+    size_t hgetall(const std::string& key, std::vector<std::pair<std::string, std::string>>& fields);
+    
+    long long lpush(const std::string& key, const std::string& value);
+    long long rpush(const std::string& key, const std::string& value);
+    bool lpop(const std::string& key, std::string& value);
+    bool rpop(const std::string& key, std::string& value);
+    size_t lrange(const std::string& key, long long start, long long stop, std::vector<std::string>& values);
+    size_t llen(const std::string& key);
+    
+    long long sadd(const std::string& key, const std::string& member);
+    bool srem(const std::string& key, const std::string& member);
+    bool sismember(const std::string& key, const std::string& member);
+    size_t smembers(const std::string& key, std::vector<std::string>& members);
+    size_t scard(const std::string& key);
+    
+    void handle_client(int client_fd, const std::string& client_addr);
+    void start_server(int port);
+    void subscribe_client(int client_fd, const std::string& channel);
+    void unsubscribe_client(int client_fd, const std::string& channel);
+};
+
+#endif
@@ -0,0 +1,210 @@
+#include "redis_core.h"
+
+RedisValue* RedisClone::find_live(const std::string& key, RedisValue::Type type) {
+    auto it = data.find(key);
+    if (it == data.end() || it->second->is_expired() || it->second->type != type) {
+        return nullptr;
+    }
+    it->second->touch(lru_clock.load(std::memory_order_relaxed));
+    return it->second.get();
+}
+
+RedisValue* RedisClone::find_or_create(const std::string& key, RedisValue::Type type) {
+    auto it = data.find(key);
+    if (it != data.end() && !it->second->is_expired()) {
+        if (it->second->type != type) return nullptr;
+        it->second->touch(lru_clock.load(std::memory_order_relaxed));
+        return it->second.get();
+    }
+    
+    auto value = std::make_shared<RedisValue>(type);
+    RedisValue* raw = value.get();
+    return insert_key(key, std::move(value)) ? raw : nullptr;
+}
+
+bool RedisClone::set(const std::string& key, const std::string& value, int ttl_seconds) {
+    auto entry = std::make_shared<RedisValue>(RedisValue::STRING);
+    entry->assign_string(value);
+    if (ttl_seconds > 0) entry->set_expiry(ttl_seconds);
+    
+    std::unique_lock<ProfiledSharedMutex> lock(data_mutex);
+    return insert_key(key, std::move(entry));
+}
+
+bool RedisClone::get(const std::string& key, std::string& value) {
+    ReadSection section(*this);
+    const ReadIndex::Entry* entry = key_index.find(key);
+    if (!entry || entry->is_expired() || entry->type != RedisValue::STRING) return false;
+    entry->touch(lru_clock.load(std::memory_order_relaxed));
+    value.assign(*entry->str);
+    return true;
+}
+
+bool RedisClone::del(const std::string& key) {
+    std::unique_lock<ProfiledSharedMutex> lock(data_mutex);
+    auto it = data.find(key);
+    if (it == data.end()) return false;
+    erase_key(it, lazyfree_user_del.load(std::memory_order_relaxed));
+    return true;
+}
+
+bool RedisClone::exists(const std::string& key) {
+    ReadSection section(*this);
+    const ReadIndex::Entry* entry = key_index.find(key);
+    return entry && !entry->is_expired();
+}
+
+bool RedisClone::expire(const std::string& key, int seconds) {
+    std::unique_lock<ProfiledSharedMutex> lock(data_mutex);
+    auto it = data.find(key);
+    if (it == data.end() || it->second->is_expired()) return false;
+    it->second->set_expiry(seconds);
+    publish_key(it->first, it->second);
+    return true;
+}
+
+long long RedisClone::ttl(const std::string& key) {
+    ReadSection section(*this);
+    const ReadIndex::Entry* entry = key_index.find(key);
+    if (!entry || entry->is_expired()) return -2;
+    if (!entry->has_expiry) return -1;
+    
+    auto remaining = entry->expiry - std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::seconds>(remaining).count();
+}
+
+long long RedisClone::hset(const std::string& key, const std::string& field, const std::string& value) {
+    std::unique_lock<ProfiledSharedMutex> lock(data_mutex);
+    RedisValue* entry = find_or_create(key, RedisValue::HASH);
+    if (!entry) return -1;
+    
+    auto inserted = entry->hash_val.insert_or_assign(field, value);
+    return inserted.second ? 1 : 0;
+}
+
+bool RedisClone::hget(const std::string& key, const std::string& field, std::string& value) {
+    std::shared_lock<ProfiledSharedMutex> lock(data_mutex);
+    RedisValue* entry = find_live(key, RedisValue::HASH);
+    if (!entry) return false;
+    
+    auto it = entry->hash_val.find(field);
+    if (it == entry->hash_val.end()) return false;
+    value.assign(it->second);
+    return true;
+}
+
+bool RedisClone::hdel(const std::string& key, const std::string& field) {
+    std::unique_lock<ProfiledSharedMutex> lock(data_mutex);
+    RedisValue* entry = find_live(key, RedisValue::HASH);
+    return entry && entry->hash_val.erase(field) > 0;
+}
+
+size_t RedisClone::hgetall(const std::string& key, std::vector<std::pair<std::string, std::string>>& fields) {
+    fields.clear();
+    std::shared_lock<ProfiledSharedMutex> lock(data_mutex);
+    RedisValue* entry = find_live(key, RedisValue::HASH);
+    if (!entry) return 0;
+    
+    fields.assign(entry->hash_val.begin(), entry->hash_val.end());
+    return fields.size();
+}
+
+long long RedisClone::lpush(const std::string& key, const std::string& value) {
+    std::unique_lock<ProfiledSharedMutex> lock(data_mutex);
+    RedisValue* entry = find_or_create(key, RedisValue::LIST);
+    if (!entry) return -1;
+    
+    entry->list_val.push_front(value);
+    return entry->list_val.size();
+}
+
+long long RedisClone::rpush(const std::string& key, const std::string& value) {
+    std::unique_lock<ProfiledSharedMutex> lock(data_mutex);
+    RedisValue* entry = find_or_create(key, RedisValue::LIST);
+    if (!entry) return -1;
+    
+    entry->list_val.push_back(value);
+    return entry->list_val.size();
+}
+
+bool RedisClone::lpop(const std::string& key, std::string& value) {
+    std::unique_lock<ProfiledSharedMutex> lock(data_mutex);
+    RedisValue* entry = find_live(key, RedisValue::LIST);
+    if (!entry || entry->list_val.empty()) return false;
+    
+    value.swap(entry->list_val.front());
+    entry->list_val.pop_front();
+    return true;
+}
+
+bool RedisClone::rpop(const std::string& key, std::string& value) {
+    std::unique_lock<ProfiledSharedMutex> lock(data_mutex);
+    RedisValue* entry = find_live(key, RedisValue::LIST);
+    if (!entry || entry->list_val.empty()) return false;
+    
+    value.swap(entry->list_val.back());
+    entry->list_val.pop_back();
+    return true;
+}
+
+size_t RedisClone::lrange(const std::string& key, long long start, long long stop, std::vector<std::string>& values) {
+    values.clear();
+    std::shared_lock<ProfiledSharedMutex> lock(data_mutex);
+    RedisValue* entry = find_live(key, RedisValue::LIST);
+    if (!entry) return 0;
+    
+    long long size = entry->list_val.size();
+    if (start < 0) start += size;
+    if (stop < 0) stop += size;
+    if (start < 0) start = 0;
+    if (stop >= size) stop = size - 1;
+    if (start > stop) return 0;
+    
+    auto it = entry->list_val.begin();
+    std::advance(it, start);
+    for (long long i = start; i <= stop; ++i, ++it) {
+        values.push_back(*it);
+    }
+    return values.size();
+}
+
+size_t RedisClone::llen(const std::string& key) {
+    std::shared_lock<ProfiledSharedMutex> lock(data_mutex);
+    RedisValue* entry = find_live(key, RedisValue::LIST);
+    return entry ? entry->list_val.size() : 0;
+}
+
+long long RedisClone::sadd(const std::string& key, const std::string& member) {
+    std::unique_lock<ProfiledSharedMutex> lock(data_mutex);
+    RedisValue* entry = find_or_create(key, RedisValue::SET);
+    if (!entry) return -1;
+    return entry->set_val.insert(member).second ? 1 : 0;
+}
+
+bool RedisClone::srem(const std::string& key, const std::string& member) {
+    std::unique_lock<ProfiledSharedMutex> lock(data_mutex);
+    RedisValue* entry = find_live(key, RedisValue::SET);
+    return entry && entry->set_val.erase(member) > 0;
+}
+
+bool RedisClone::sismember(const std::string& key, const std::string& member) {
+    std::shared_lock<ProfiledSharedMutex> lock(data_mutex);
+    RedisValue* entry = find_live(key, RedisValue::SET);
+    return entry && entry->set_val.count(member) > 0;
+}
+
+size_t RedisClone::smembers(const std::string& key, std::vector<std::string>& members) {
+    members.clear();
+    std::shared_lock<ProfiledSharedMutex> lock(data_mutex);
+    RedisValue* entry = find_live(key, RedisValue::SET);
+    if (!entry) return 0;
+    
+    members.assign(entry->set_val.begin(), entry->set_val.end());
+    return members.size();
+}
+
+size_t RedisClone::scard(const std::string& key) {
+    std::shared_lock<ProfiledSharedMutex> lock(data_mutex);
+    RedisValue* entry = find_live(key, RedisValue::SET);
+    return entry ? entry->set_val.size() : 0;
+}
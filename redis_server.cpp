@@ -0,0 +1,491 @@
+#include "redis_core.h"
+
+#include <climits>
+#include <cstring>
+#include <netinet/tcp.h>
+#include <sys/uio.h>
+#include <linux/errqueue.h>
+
+// Sends every iovec, resuming after partial writes. Returns false if the
+// connection failed.
+static bool send_iovecs(int fd, std::vector<iovec>& iov, int flags) {
+    size_t first = 0;
+    while (first < iov.size()) {
+        msghdr msg{};
+        msg.msg_iov = iov.data() + first;
+        msg.msg_iovlen = std::min<size_t>(iov.size() - first, IOV_MAX);
+        ssize_t sent = sendmsg(fd, &msg, flags | MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+        
+        while (first < iov.size() && static_cast<size_t>(sent) >= iov[first].iov_len) {
+            sent -= iov[first].iov_len;
+            first++;
+        }
+        if (sent > 0) {
+            iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + sent;
+            iov[first].iov_len -= sent;
+        }
+    }
+    return true;
+}
+
+// Drops the pins of every zero-copy send the kernel has reported complete.
+static void reap_zerocopy(int fd, ZeroCopyPins& pins) {
+    while (!pins.pending.empty()) {
+        char control[128];
+        msghdr msg{};
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        if (recvmsg(fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) return;
+        
+        for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            sock_extended_err err;
+            memcpy(&err, CMSG_DATA(cmsg), sizeof(err));
+            if (err.ee_errno != 0 || err.ee_origin != SO_EE_ORIGIN_ZEROCOPY) continue;
+            
+            // Completions cover the inclusive id range [ee_info, ee_data].
+            auto done = [&](const std::pair<uint32_t, SharedValue>& pin) {
+                return pin.first - err.ee_info <= err.ee_data - err.ee_info;
+            };
+            pins.pending.erase(std::remove_if(pins.pending.begin(), pins.pending.end(), done), pins.pending.end());
+        }
+    }
+}
+
+// Sends one value with MSG_ZEROCOPY, pinning it until completion. Each
+// successful sendmsg consumes one notification id.
+static bool send_zerocopy(int fd, const SharedValue& value, ZeroCopyPins& pins) {
+    size_t offset = 0;
+    while (offset < value->size()) {
+        ssize_t sent = send(fd, value->data() + offset, value->size() - offset, MSG_ZEROCOPY | MSG_MORE | MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent < 0 && errno == ENOBUFS) {
+            // Out of optmem for pinned pages: copy the remainder instead.
+            std::vector<iovec> rest = {{const_cast<char*>(value->data()) + offset, value->size() - offset}};
+            return send_iovecs(fd, rest, MSG_MORE);
+        }
+        if (sent <= 0) return false;
+        
+        pins.pending.emplace_back(pins.next_id++, value);
+        offset += sent;
+    }
+    return true;
+}
+
+// Sends as much of the pending output as the socket takes without blocking.
+void RedisClone::flush_monitor(MonitorClient& client) {
+    if (client.pending.empty()) return;
+    ssize_t sent = send(client.fd, client.pending.data(), client.pending.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (sent > 0) client.pending.erase(0, sent);
+}
+
+// Called by a monitor's own connection thread in place of sending. Replies
+// are never dropped, only monitor records; past kMonitorMaxPending the
+// caller waits for the drain thread, as a blocking send would.
+bool RedisClone::queue_monitor_reply(int client_fd, const std::string& output) {
+    std::unique_lock<std::mutex> lock(monitor_mutex);
+    auto find = [&]() {
+        return std::find_if(monitor_clients.begin(), monitor_clients.end(),
+                            [&](const MonitorClient& client) { return client.fd == client_fd; });
+    };
+    auto client = find();
+    if (client == monitor_clients.end()) return false;
+    client->pending += output;
+    flush_monitor(*client);
+    
+    while (running && client != monitor_clients.end() && client->pending.size() > kMonitorMaxPending) {
+        lock.unlock();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        lock.lock();
+        client = find();
+    }
+    return true;
+}
+
+void RedisClone::drain_monitors() {
+    while (running) {
+        size_t drained = 0;
+        {
+            std::lock_guard<std::mutex> lock(monitor_mutex);
+            if (monitor_clients.empty()) {
+                monitor_drain_running = false;
+                return;
+            }
+            
+            worker_stats.for_each([&](WorkerStats& stats) {
+                drained += stats.monitor.drain([&](const MonitorRing::Record& record) {
+                    std::string line;
+                    for (auto& client : monitor_clients) {
+                        if (record.sequence % client.sample_rate != 0) continue;
+                        const std::string& prefix = client.prefix;
+                        if (!prefix.empty() && (record.args.size() < 2 || record.args[1].rfind(prefix, 0) != 0)) {
+                            continue;
+                        }
+                        if (line.empty()) line = format_monitor_record(record);
+                        if (client.pending.size() + line.size() > kMonitorMaxPending) {
+                            monitor_dropped.fetch_add(1, std::memory_order_relaxed);
+                            continue;
+                        }
+                        client.pending += line;
+                    }
+                });
+            });
+            
+            for (auto& client : monitor_clients) {
+                flush_monitor(client);
+            }
+        }
+        
+        if (drained == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+void RedisClone::remove_monitor(int client_fd) {
+    std::lock_guard<std::mutex> lock(monitor_mutex);
+    for (auto& client : monitor_clients) {
+        if (client.fd == client_fd) flush_monitor(client);
+    }
+    monitor_clients.erase(std::remove_if(monitor_clients.begin(), monitor_clients.end(),
+                                         [&](const MonitorClient& client) { return client.fd == client_fd; }),
+                          monitor_clients.end());
+    monitor_active = !monitor_clients.empty();
+    update_monitor_stride();
+}
+
+// Requires monitor_mutex.
+void RedisClone::update_monitor_stride() {
+    uint64_t stride = 0;
+    for (const auto& client : monitor_clients) {
+        stride = std::gcd<uint64_t>(stride, client.sample_rate);
+    }
+    monitor_sample_stride = static_cast<uint32_t>(std::max<uint64_t>(stride, 1));
+}
+
+void RedisClone::serve_metrics(int server_fd) {
+    while (running) {
+        int client_fd = accept(server_fd, nullptr, nullptr);
+        if (client_fd < 0) {
+            if (!running || metrics_fd.load() < 0) break;
+            continue;
+        }
+        
+        timeval timeout{5, 0};
+        setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        
+        std::string request;
+        char buffer[1024];
+        while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+            ssize_t bytes_read = recv(client_fd, buffer, sizeof(buffer), 0);
+            if (bytes_read <= 0) break;
+            request.append(buffer, bytes_read);
+        }
+        
+        std::string response;
+        if (request.rfind("GET /metrics ", 0) == 0 || request.rfind("GET / ", 0) == 0) {
+            std::string body = render_metrics();
+            response = "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                       "Content-Length: " + std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+        } else {
+            response = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        }
+        
+        send(client_fd, response.c_str(), response.length(), MSG_NOSIGNAL);
+        close(client_fd);
+    }
+}
+
+void RedisClone::start_metrics_server() {
+    int server_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (server_fd == -1) {
+        perror("Metrics socket creation failed");
+        return;
+    }
+    
+    int opt = 1;
+    setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    
+    sockaddr_in address;
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = INADDR_ANY;
+    address.sin_port = htons(metrics_port);
+    
+    if (bind(server_fd, (struct sockaddr*)&address, sizeof(address)) < 0 || listen(server_fd, 16) < 0) {
+        perror("Metrics listener failed");
+        close(server_fd);
+        return;
+    }
+    
+    metrics_fd = server_fd;
+    metrics_thread = std::thread(&RedisClone::serve_metrics, this, server_fd);
+    std::cout << "Metrics endpoint listening on port " << metrics_port << std::endl;
+}
+
+void RedisClone::open_client_info(ClientInfo& info, int client_fd, const std::string& client_addr) {
+    info.id = next_client_id.fetch_add(1);
+    info.last_interaction_ns = steady_now_ns();
+    info.net_input_bytes = 0;
+    info.net_output_bytes = 0;
+    info.commands = 0;
+    info.query_buffer = 0;
+    info.output_buffer = 0;
+    info.current_command = CMD_COUNT;
+    info.killed = false;
+    
+    std::lock_guard<std::mutex> lock(info.info_mutex);
+    info.active = true;
+    info.fd = client_fd;
+    info.addr = client_addr;
+    info.name.clear();
+    info.created_at = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+ssize_t RedisClone::send_reply(int client_fd, const std::string& output, const std::vector<ReplyRef>& refs, ZeroCopyPins& pins) {
+    if (refs.empty()) {
+        size_t offset = 0;
+        while (offset < output.size()) {
+            ssize_t sent = send(client_fd, output.data() + offset, output.size() - offset, MSG_NOSIGNAL);
+            if (sent < 0 && errno == EINTR) continue;
+            if (sent <= 0) return -1;
+            offset += sent;
+        }
+        return offset;
+    }
+    
+    uint64_t zerocopy_min = zerocopy_threshold.load(std::memory_order_relaxed);
+    std::vector<iovec> iov;
+    iov.reserve(refs.size() * 2 + 1);
+    size_t offset = 0, total = output.size();
+    for (const ReplyRef& ref : refs) {
+        if (ref.offset > offset) {
+            iov.push_back({const_cast<char*>(output.data()) + offset, ref.offset - offset});
+            offset = ref.offset;
+        }
+        total += ref.value->size();
+        
+        if (zerocopy_min > 0 && ref.value->size() >= zerocopy_min && !pins.unsupported) {
+            if (!pins.enabled) {
+                int one = 1;
+                pins.enabled = setsockopt(client_fd, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) == 0;
+                pins.unsupported = !pins.enabled;
+                // A value's header, pages and trailer now leave in separate
+                // sends; without this Nagle holds the trailer for an ACK.
+                setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            }
+            if (pins.enabled) {
+                if (!send_iovecs(client_fd, iov, MSG_MORE) || !send_zerocopy(client_fd, ref.value, pins)) return -1;
+                iov.clear();
+                continue;
+            }
+        }
+        iov.push_back({const_cast<char*>(ref.value->data()), ref.value->size()});
+    }
+    if (offset < output.size()) {
+        iov.push_back({const_cast<char*>(output.data()) + offset, output.size() - offset});
+    }
+    if (!send_iovecs(client_fd, iov, 0)) return -1;
+    
+    reap_zerocopy(client_fd, pins);
+    return total;
+}
+
+void RedisClone::handle_client(int client_fd, const std::string& client_addr) {
+    int conn_id = connection_pool.acquire_connection();
+    if (conn_id == -1) {
+        close(client_fd);
+        return;
+    }
+    
+    tls_worker_stats = worker_stats.acquire();
+    tls_lock_profile = &tls_worker_stats->locks;
+    tls_client_addr = client_addr;
+    tls_client_fd = client_fd;
+    ClientInfo& info = tls_worker_stats->client;
+    open_client_info(info, client_fd, client_addr);
+    
+    char buffer[16384];
+    std::string command_buffer;
+    size_t parsed = 0;
+    std::string& output = tls_worker_stats->reply_buffer;
+    output.clear();
+    std::vector<ReplyRef>& refs = tls_worker_stats->reply_refs;
+    refs.clear();
+    tls_reply_refs = &refs;
+    ZeroCopyPins pins;
+    std::vector<std::string> tokens;
+    bool protocol_error = false;
+    
+    while (!protocol_error) {
+        ssize_t bytes_read = recv(client_fd, buffer, sizeof(buffer), 0);
+        TRACE_PROBE2(conn__recv, client_fd, bytes_read);
+        if (bytes_read <= 0) break;
+        tls_worker_stats->net_input_bytes.fetch_add(bytes_read, std::memory_order_relaxed);
+        info.net_input_bytes.fetch_add(bytes_read, std::memory_order_relaxed);
+        info.last_interaction_ns.store(steady_now_ns(), std::memory_order_relaxed);
+        command_buffer.append(buffer, bytes_read);
+        
+        // Every complete request in the buffer is executed before replying,
+        // so a pipelined batch costs one send() instead of one per command.
+        while (!info.killed.load(std::memory_order_relaxed)) {
+            RequestStatus status = parse_request(command_buffer, parsed, tokens);
+            if (status == REQUEST_INCOMPLETE) break;
+            if (status == REQUEST_ERROR) {
+                append_error(output, "ERR Protocol error: invalid request");
+                protocol_error = true;
+                break;
+            }
+            if (tokens.empty()) continue;
+            
+            process_command(tokens, output);
+            info.commands.fetch_add(1, std::memory_order_relaxed);
+            info.current_command.store(CMD_COUNT, std::memory_order_relaxed);
+        }
+        command_buffer.erase(0, parsed);
+        parsed = 0;
+        info.query_buffer.store(command_buffer.size(), std::memory_order_relaxed);
+        
+        if (!output.empty()) {
+            info.output_buffer.store(output.length(), std::memory_order_relaxed);
+            ssize_t sent = tls_monitoring && queue_monitor_reply(client_fd, output)
+                               ? static_cast<ssize_t>(output.size())
+                               : send_reply(client_fd, output, refs, pins);
+            TRACE_PROBE2(conn__send, client_fd, sent);
+            info.output_buffer.store(0, std::memory_order_relaxed);
+            if (sent > 0) {
+                tls_worker_stats->net_output_bytes.fetch_add(sent, std::memory_order_relaxed);
+                info.net_output_bytes.fetch_add(sent, std::memory_order_relaxed);
+            }
+            output.clear();
+            refs.clear();
+            if (output.capacity() > WorkerStats::kReplyBufferKeep) {
+                std::string().swap(output);
+            }
+            if (sent < 0) break;
+        }
+    }
+    
+    remove_monitor(client_fd);
+    tls_monitoring = false;
+    refs.clear();
+    tls_reply_refs = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(info.info_mutex);
+        info.active = false;
+    }
+    worker_stats.release(tls_worker_stats);
+    tls_worker_stats = nullptr;
+    tls_lock_profile = nullptr;
+    tls_client_fd = -1;
+    
+    connection_pool.release_connection(conn_id);
+    close_client(client_fd, pins);
+}
+
+// Closes the socket unless zero-copy sends on it are still in flight, in
+// which case it is parked until the kernel is done with their pages.
+void RedisClone::close_client(int client_fd, ZeroCopyPins& pins) {
+    reap_zerocopy(client_fd, pins);
+    if (pins.pending.empty()) {
+        close(client_fd);
+        return;
+    }
+    // Every reply is already queued, so the FIN goes out after it.
+    shutdown(client_fd, SHUT_RDWR);
+    std::lock_guard<std::mutex> lock(zerocopy_orphans_mutex);
+    zerocopy_orphans.push_back({client_fd, std::move(pins), std::chrono::steady_clock::now() + kZeroCopyOrphanTimeout});
+}
+
+void RedisClone::reap_zerocopy_orphans() {
+    std::vector<ZeroCopyOrphan> orphans;
+    {
+        std::lock_guard<std::mutex> lock(zerocopy_orphans_mutex);
+        if (zerocopy_orphans.empty()) return;
+        orphans.swap(zerocopy_orphans);
+    }
+    
+    auto now = std::chrono::steady_clock::now();
+    std::vector<ZeroCopyOrphan> waiting;
+    for (auto& orphan : orphans) {
+        reap_zerocopy(orphan.fd, orphan.pins);
+        if (!orphan.pins.pending.empty() && now >= orphan.deadline) {
+            if (orphan.reset) {
+                // The send queue was purged a grace period ago; whatever
+                // completions are still missing are not coming.
+                orphan.pins.pending.clear();
+            } else {
+                // Disconnecting a TCP socket resets it and frees its unsent
+                // data, releasing the kernel's references to the pages.
+                sockaddr unspec{};
+                unspec.sa_family = AF_UNSPEC;
+                connect(orphan.fd, &unspec, sizeof(unspec));
+                orphan.reset = true;
+                orphan.deadline = now + kZeroCopyResetGrace;
+            }
+        }
+        if (orphan.pins.pending.empty()) {
+            close(orphan.fd);
+        } else {
+            waiting.push_back(std::move(orphan));
+        }
+    }
+    
+    std::lock_guard<std::mutex> lock(zerocopy_orphans_mutex);
+    for (auto& orphan : waiting) {
+        zerocopy_orphans.push_back(std::move(orphan));
+    }
+}
+
+void RedisClone::start_server(int port) {
+    int server_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (server_fd == -1) {
+        perror("Socket creation failed");
+        return;
+    }
+    
+    int opt = 1;
+    setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    
+    sockaddr_in address;
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = INADDR_ANY;
+    address.sin_port = htons(port);
+    
+    if (bind(server_fd, (struct sockaddr*)&address, sizeof(address)) < 0) {
+        perror("Bind failed");
+        close(server_fd);
+        return;
+    }
+    
+    if (listen(server_fd, SOMAXCONN) < 0) {
+        perror("Listen failed");
+        close(server_fd);
+        return;
+    }
+    
+    std::cout << "Redis clone server started on port " << port << std::endl;
+    
+    if (metrics_port > 0) {
+        start_metrics_server();
+    }
+    
+    while (running) {
+        sockaddr_in client_addr;
+        socklen_t client_len = sizeof(client_addr);
+        int client_fd = accept(server_fd, (struct sockaddr*)&client_addr, &client_len);
+        
+        if (client_fd >= 0) {
+            total_connections_received.fetch_add(1, std::memory_order_relaxed);
+            char ip[INET_ADDRSTRLEN] = "";
+            inet_ntop(AF_INET, &client_addr.sin_addr, ip, sizeof(ip));
+            std::string peer = std::string(ip) + ":" + std::to_string(ntohs(client_addr.sin_port));
+            
+            std::thread client_thread(&RedisClone::handle_client, this, client_fd, peer);
+            client_thread.detach();
+        }
+    }
+    
+    close(server_fd);
+}
@@ -3,16 +3,19 @@
 #include <vector>
 #include <thread>
 #include <chrono>
+#include <atomic>
 #include <cassert>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
 
+#include "redis_core.h"
+
 class RedisTestClient {
 private:
     int sock_fd;
-    
+
 public:
     RedisTestClient() : sock_fd(-1) {}
     
@@ -47,6 +50,34 @@ public:
         buffer[bytes_received] = '\0';
         return std::string(buffer);
     }
+    
+    // For streams such as MONITOR: sends a command, then reads until marker
+    // shows up in what was received.
+    std::string send_until(const std::string& command, const std::string& marker) {
+        std::string reply = send_command(command);
+        char buffer[4096];
+        for (int reads = 0; reply.find(marker) == std::string::npos && reads < 100; ++reads) {
+            ssize_t bytes_received = recv(sock_fd, buffer, sizeof(buffer), 0);
+            if (bytes_received <= 0) break;
+            reply.append(buffer, bytes_received);
+        }
+        return reply;
+    }
+    
+    // For replies too large for one recv: reads until reply_size bytes arrive.
+    std::string send_raw(const std::string& request, size_t reply_size) {
+        if (sock_fd < 0) return "";
+        
+        send(sock_fd, request.data(), request.size(), 0);
+        std::string reply;
+        char buffer[65536];
+        while (reply.size() < reply_size) {
+            ssize_t bytes_received = recv(sock_fd, buffer, sizeof(buffer), 0);
+            if (bytes_received <= 0) break;
+            reply.append(buffer, bytes_received);
+        }
+        return reply;
+    }
 };
 
 class TestRunner {
@@ -63,7 +94,7 @@ private:
             tests_failed++;
         }
     }
-    
+
 public:
     void run_basic_string_tests() {
         std::cout << "\n=== Basic String Operations Tests ===" << std::endl;
@@ -346,6 +377,375 @@ public:
         tests_passed++;
     }
     
+    void run_info_tests() {
+        std::cout << "\n=== INFO Statistics Tests ===" << std::endl;
+        
+        RedisTestClient client;
+        assert(client.connect_to_server());
+        
+        client.send_command("SET stats_key stats_value");
+        client.send_command("GET stats_key");
+        
+        std::string response = client.send_command("INFO");
+        assert_response(response, "# Keyspace", "INFO default sections");
+        
+        response = client.send_command("INFO commandstats");
+        assert_response(response, "cmdstat_get:calls=", "INFO commandstats");
+        
+        response = client.send_command("INFO cpu");
+        assert_response(response, "used_cpu_user:", "INFO cpu");
+        
+        response = client.send_command("INFO latencystats");
+        assert_response(response, "latency_percentiles_usec_set:p50=", "INFO latencystats");
+    }
+    
+    void run_slowlog_tests() {
+        std::cout << "\n=== SLOWLOG Tests ===" << std::endl;
+        
+        RedisTestClient client;
+        assert(client.connect_to_server());
+        
+        std::string response = client.send_command("SLOWLOG RESET");
+        assert_response(response, "+OK", "SLOWLOG RESET");
+        
+        response = client.send_command("CONFIG SET slowlog-log-slower-than 0");
+        assert_response(response, "+OK", "CONFIG SET slowlog threshold");
+        
+        response = client.send_command("CONFIG GET slowlog-log-slower-than");
+        assert_response(response, "$1\r\n0", "CONFIG GET slowlog threshold");
+        
+        client.send_command("SET slow_key slow_value");
+        response = client.send_command("SLOWLOG GET 1");
+        assert_response(response, "$10\r\nslow_value", "SLOWLOG GET records arguments");
+        
+        response = client.send_command("SLOWLOG LEN");
+        assert_response(response, ":", "SLOWLOG LEN");
+        
+        client.send_command("CONFIG SET slowlog-log-slower-than 10000");
+        response = client.send_command("SLOWLOG RESET");
+        response = client.send_command("SLOWLOG LEN");
+        assert_response(response, ":0", "SLOWLOG LEN after reset");
+    }
+    
+    void run_latency_monitor_tests() {
+        std::cout << "\n=== LATENCY Monitor Tests ===" << std::endl;
+        
+        RedisTestClient client;
+        assert(client.connect_to_server());
+        
+        std::string response = client.send_command("LATENCY DOCTOR");
+        assert_response(response, "disabled", "LATENCY DOCTOR when disabled");
+        
+        response = client.send_command("CONFIG SET latency-monitor-threshold 100");
+        assert_response(response, "+OK", "CONFIG SET latency-monitor-threshold");
+        
+        response = client.send_command("LATENCY LATEST");
+        assert_response(response, "*", "LATENCY LATEST");
+        
+        response = client.send_command("LATENCY HISTORY command");
+        assert_response(response, "*", "LATENCY HISTORY");
+        
+        response = client.send_command("LATENCY RESET");
+        assert_response(response, ":", "LATENCY RESET");
+        
+        client.send_command("CONFIG SET latency-monitor-threshold 0");
+    }
+    
+    void run_hotkeys_tests() {
+        std::cout << "\n=== HOTKEYS Tests ===" << std::endl;
+        
+        RedisTestClient client;
+        assert(client.connect_to_server());
+        
+        client.send_command("SET very_hot_key value");
+        for (int i = 0; i < 500; ++i) {
+            client.send_command("GET very_hot_key");
+        }
+        
+        std::string response = client.send_command("HOTKEYS 5");
+        assert_response(response, "very_hot_key", "HOTKEYS reports frequently read key");
+    }
+    
+    void run_keyspace_analysis_tests() {
+        std::cout << "\n=== Keyspace Analysis Tests ===" << std::endl;
+        
+        RedisTestClient client;
+        assert(client.connect_to_server());
+        
+        client.send_command("FLUSHALL");
+        client.send_command("RPUSH big_list a b c d e f g h");
+        client.send_command("HSET small_hash f1 v1");
+        client.send_command("SET ttl_key value EX 100");
+        
+        std::string response = client.send_command("BIGKEYS START FULL SLEEP 0");
+        assert_response(response, "+OK", "BIGKEYS START");
+        
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        response = client.send_command("BIGKEYS REPORT");
+        assert_response(response, "big_list elements=8", "BIGKEYS REPORT largest list");
+        
+        response = client.send_command("INFO keyspace_analysis");
+        assert_response(response, "ttl_lt_1h:1", "INFO keyspace_analysis TTL histogram");
+    }
+    
+    void run_monitor_tests() {
+        std::cout << "\n=== MONITOR Tests ===" << std::endl;
+        
+        RedisTestClient monitor, client;
+        assert(monitor.connect_to_server());
+        assert(client.connect_to_server());
+        
+        std::string response = monitor.send_command("MONITOR PREFIX mon_");
+        assert_response(response, "+OK", "MONITOR with prefix filter");
+        
+        client.send_command("SET other_key value");
+        client.send_command("SET mon_key monitored_value");
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        
+        response = monitor.send_command("PING");
+        assert_response(response, "\"SET\" \"mon_key\" \"monitored_value\"", "MONITOR streams matching commands");
+        
+        if (response.find("other_key") == std::string::npos) {
+            std::cout << "✓ MONITOR prefix filter excludes other keys" << std::endl;
+            tests_passed++;
+        } else {
+            std::cout << "✗ MONITOR prefix filter excludes other keys - Got: " << response << std::endl;
+            tests_failed++;
+        }
+        
+        // The monitor's own replies and the records share one writer, so
+        // every complete line in the stream is a whole record or reply.
+        for (int i = 0; i < 40; ++i) {
+            client.send_command("SET mon_burst_" + std::to_string(i) + " value");
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        response = monitor.send_until("PING", "+PONG\r\n");
+        bool well_formed = true;
+        for (size_t start = 0, end; (end = response.find("\r\n", start)) != std::string::npos; start = end + 2) {
+            if (response[start] != '+') well_formed = false;
+        }
+        if (well_formed && response.find("+PONG") != std::string::npos) {
+            std::cout << "✓ MONITOR stream stays line-aligned" << std::endl;
+            tests_passed++;
+        } else {
+            std::cout << "✗ MONITOR stream stays line-aligned - Got: " << response.substr(0, 200) << std::endl;
+            tests_failed++;
+        }
+        
+        // A sampled monitor must not change what an unsampled one sees.
+        RedisTestClient sampled;
+        assert(sampled.connect_to_server());
+        assert_response(sampled.send_command("MONITOR SAMPLE 1000"), "+OK", "MONITOR SAMPLE on a second connection");
+        for (int i = 0; i < 5; ++i) {
+            client.send_command("SET mon_rate_" + std::to_string(i) + " value");
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        response = monitor.send_until("PING", "+PONG\r\n");
+        bool all_seen = true;
+        for (int i = 0; i < 5; ++i) {
+            if (response.find("\"mon_rate_" + std::to_string(i) + "\"") == std::string::npos) all_seen = false;
+        }
+        if (all_seen) {
+            std::cout << "✓ MONITOR sample rate is per monitor" << std::endl;
+            tests_passed++;
+        } else {
+            std::cout << "✗ MONITOR sample rate is per monitor - Got: " << response.substr(0, 200) << std::endl;
+            tests_failed++;
+        }
+    }
+    
+    void run_lock_profiling_tests() {
+        std::cout << "\n=== Lock Profiling Tests ===" << std::endl;
+        
+        RedisTestClient client;
+        assert(client.connect_to_server());
+        
+        std::string response = client.send_command("CONFIG SET lock-profiling yes");
+        assert_response(response, "+OK", "CONFIG SET lock-profiling");
+        
+        client.send_command("SET lock_key value");
+        client.send_command("GET lock_key");
+        
+        response = client.send_command("INFO lockstats");
+        assert_response(response, "lock_keyspace_set:acquisitions=", "INFO lockstats per command");
+        
+        client.send_command("CONFIG SET lock-profiling no");
+    }
+    
+    void run_client_tests() {
+        std::cout << "\n=== Client Tests ===" << std::endl;
+        
+        RedisTestClient client;
+        RedisTestClient victim;
+        assert(client.connect_to_server());
+        assert(victim.connect_to_server());
+        
+        std::string response = client.send_command("CLIENT SETNAME tester");
+        assert_response(response, "+OK", "CLIENT SETNAME");
+        
+        response = client.send_command("CLIENT LIST");
+        assert_response(response, "name=tester", "CLIENT LIST shows name");
+        
+        std::string id = victim.send_command("CLIENT ID");
+        id = id.substr(1, id.find("\r\n") - 1);
+        response = client.send_command("CLIENT KILL ID " + id);
+        assert_response(response, ":1", "CLIENT KILL ID");
+    }
+    
+    void run_embedded_tests() {
+        std::cout << "\n=== Embedded Engine Tests ===" << std::endl;
+        
+        RedisClone engine;
+        std::string response = engine.execute({"SET", "embedded", "in process"});
+        assert_response(response, "+OK", "Embedded SET");
+        
+        response = engine.execute({"GET", "embedded"});
+        assert_response(response, "$10\r\nin process\r\n", "Embedded GET");
+        
+        const char* argv[] = {"HSET", "embedded:hash", "field", "a\0b"};
+        const size_t argv_len[] = {4, 13, 5, 3};
+        engine.execute(4, argv, argv_len);
+        response = engine.execute({"HGET", "embedded:hash", "field"});
+        assert_response(response, std::string("$3\r\na\0b\r\n", 9), "Embedded binary-safe arguments");
+        
+        std::string value;
+        engine.set("typed", "value", 100);
+        engine.get("typed", value);
+        assert_response(value + " ttl=" + std::to_string(engine.ttl("typed")), "value ttl=99", "Embedded typed SET/GET with TTL");
+        
+        engine.rpush("typed:list", "a");
+        engine.rpush("typed:list", "b");
+        engine.lpop("typed:list", value);
+        assert_response(value + std::to_string(engine.llen("typed:list")) + std::to_string(engine.hset("typed:list", "f", "v")),
+                        "a1-1", "Embedded typed list ops and wrong type");
+    }
+    
+    void run_eviction_tests() {
+        std::cout << "\n=== Eviction Tests ===" << std::endl;
+        
+        RedisClone engine;
+        engine.config_set("maxkeys", "10");
+        for (int i = 0; i < 20; ++i) {
+            engine.set("evict:" + std::to_string(i), "v");
+        }
+        assert_response(engine.execute({"SET", "evict:full", "v"}), "-OOM", "noeviction rejects new keys");
+        assert_response(engine.execute({"SET", "evict:0", "v2"}), "+OK", "noeviction allows overwrites");
+        
+        engine.config_set("maxkeys-policy", "allkeys-lru");
+        for (int i = 20; i < 40; ++i) {
+            engine.set("evict:" + std::to_string(i), "v");
+        }
+        assert_response(engine.execute({"INFO", "stats"}), "evicted_keys:20", "allkeys-lru evicts to maxkeys");
+        assert_response(engine.execute({"EXISTS", "evict:39"}), ":1", "Newest key survives eviction");
+    }
+    
+    // The lock-free read commands must follow every kind of write.
+    void run_read_index_tests() {
+        std::cout << "\n=== Read Index Tests ===" << std::endl;
+        
+        RedisClone engine;
+        engine.execute({"HSET", "idx", "f", "v"});
+        assert_response(engine.execute({"HGET", "idx", "f"}), "$1\r\nv", "HGET sees HSET");
+        engine.execute({"SET", "idx", "plain"});
+        assert_response(engine.execute({"HGET", "idx", "f"}), "$-1", "Overwritten hash drops its fields");
+        engine.execute({"HSET", "idx", "g", "w"});
+        assert_response(engine.execute({"GET", "idx"}), "$5\r\nplain", "GET still sees the string");
+        
+        engine.execute({"EXPIRE", "idx", "100"});
+        assert_response(engine.execute({"TTL", "idx"}), ":99", "TTL sees EXPIRE");
+        engine.execute({"DEL", "idx"});
+        assert_response(engine.execute({"EXISTS", "idx"}), ":0", "EXISTS sees DEL");
+        
+        engine.execute({"HSET", "idx", "f", "v"});
+        engine.execute({"HDEL", "idx", "f"});
+        assert_response(engine.execute({"HGET", "idx", "f"}), "$-1", "HGET sees HDEL");
+        engine.execute({"SET", "idx2", "v"});
+        engine.execute({"FLUSHALL"});
+        assert_response(engine.execute({"GET", "idx2"}), "$-1", "GET sees FLUSHALL");
+        
+        for (int i = 0; i < 10000; ++i) {
+            engine.execute({"SET", "grow:" + std::to_string(i), std::to_string(i)});
+        }
+        assert_response(engine.execute({"GET", "grow:9999"}), "$4\r\n9999", "GET after index growth");
+    }
+    
+    void run_lazyfree_tests() {
+        std::cout << "\n=== Lazy Free Tests ===" << std::endl;
+        
+        RedisClone engine;
+        for (int i = 0; i < 1000; ++i) {
+            engine.execute({"RPUSH", "lazy:list", std::to_string(i)});
+        }
+        engine.execute({"SET", "lazy:str", "v"});
+        assert_response(engine.execute({"UNLINK", "lazy:list", "lazy:str", "lazy:missing"}), ":2", "UNLINK returns deleted count");
+        assert_response(engine.execute({"EXISTS", "lazy:list"}), ":0", "UNLINK removes the key");
+        assert_response(engine.execute({"UNLINK"}), "wrong number of arguments", "UNLINK without keys");
+        
+        for (int i = 0; i < 100; ++i) {
+            engine.execute({"SET", "lazy:" + std::to_string(i), "v"});
+        }
+        assert_response(engine.execute({"FLUSHALL", "ASYNC"}), "+OK", "FLUSHALL ASYNC");
+        assert_response(engine.execute({"GET", "lazy:1"}), "$-1", "FLUSHALL ASYNC empties the keyspace");
+        engine.execute({"SET", "lazy:1", "v"});
+        assert_response(engine.execute({"FLUSHDB", "sync"}), "+OK", "FLUSHDB SYNC");
+        assert_response(engine.execute({"EXISTS", "lazy:1"}), ":0", "FLUSHDB empties the keyspace");
+        assert_response(engine.execute({"FLUSHALL", "LATER"}), "syntax error", "FLUSHALL rejects unknown mode");
+        
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        assert_response(engine.execute({"INFO", "stats"}), "lazyfree_pending_objects:0", "Lazy free queue drains");
+        assert_response(engine.execute({"INFO", "stats"}), "lazyfreed_objects:101", "Lazy freed objects counted");
+        
+        for (int i = 0; i < 1000; ++i) {
+            engine.hset("lazy:hash", "field:" + std::to_string(i), "value");
+        }
+        assert_response(engine.execute({"UNLINK", "lazy:hash"}), ":1", "UNLINK a large hash");
+        assert_response(engine.execute({"EXISTS", "lazy:hash"}), ":0", "UNLINK removes the hash right away");
+        assert_response(engine.execute({"HGET", "lazy:hash", "field:1"}), "$-1", "UNLINKed hash fields are gone");
+        std::string stats;
+        for (int i = 0; i < 50; ++i) {
+            stats = engine.execute({"INFO", "stats"});
+            if (stats.find("lazyfree_pending_objects:0") != std::string::npos) break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        assert_response(stats, "lazyfree_pending_objects:0", "Lazy free queue drains after UNLINK of a hash");
+        assert_response(stats, "lazyfreed_objects:102", "UNLINKed hash is freed in the background");
+        
+        assert_response(engine.execute({"CONFIG", "SET", "lazyfree-lazy-user-del", "yes"}), "+OK", "CONFIG SET lazyfree-lazy-user-del");
+        assert_response(engine.execute({"CONFIG", "GET", "lazyfree-lazy-user-del"}), "yes", "CONFIG GET lazyfree-lazy-user-del");
+        assert_response(engine.execute({"CONFIG", "SET", "lazyfree-lazy-expire", "maybe"}), "Invalid argument", "Lazy free option rejects bad value");
+    }
+    
+    void run_large_value_tests() {
+        std::cout << "\n=== Large Value Tests ===" << std::endl;
+        
+        RedisTestClient client;
+        if (!client.connect_to_server()) return;
+        
+        std::string big;
+        for (int i = 0; i < 100000; ++i) {
+            big += static_cast<char>('a' + i % 26);
+        }
+        std::string set = "*3\r\n$3\r\nSET\r\n$7\r\nbig_key\r\n$" + std::to_string(big.size()) + "\r\n" + big + "\r\n";
+        assert_response(client.send_raw(set, 5), "+OK", "SET large value");
+        client.send_command("SET small_key small");
+        
+        std::string request = "GET big_key\r\nGET small_key\r\nGET big_key\r\n";
+        std::string big_reply = "$100000\r\n" + big + "\r\n";
+        std::string expected = big_reply + "$5\r\nsmall\r\n" + big_reply;
+        std::string reply = client.send_raw(request, expected.size());
+        assert_response(reply == expected ? "match" : reply.substr(0, 64), "match", "Pipelined large GETs splice in order");
+        
+        assert_response(client.send_command("CONFIG SET zerocopy-threshold 65536"), "+OK", "CONFIG SET zerocopy-threshold");
+        reply = client.send_raw(request, expected.size());
+        assert_response(reply == expected ? "match" : reply.substr(0, 64), "match", "Large GETs with zero-copy sends");
+        client.send_command("CONFIG SET zerocopy-threshold 0");
+        
+        RedisClone engine;
+        engine.set("big_key", big);
+        assert_response(engine.execute({"GET", "big_key"}) == big_reply ? "match" : "mismatch", "match", "Embedded GET copies large value");
+        client.send_command("DEL big_key small_key");
+    }
+    
     void run_all_tests() {
         std::cout << "Starting Redis Clone Test Suite..." << std::endl;
         std::cout << "Connecting to server on localhost:6379" << std::endl;
@@ -359,6 +759,19 @@ public:
         run_concurrent_tests();
         run_memory_stress_test();
         run_pubsub_tests();
+        run_info_tests();
+        run_slowlog_tests();
+        run_latency_monitor_tests();
+        run_hotkeys_tests();
+        run_keyspace_analysis_tests();
+        run_monitor_tests();
+        run_lock_profiling_tests();
+        run_client_tests();
+        run_embedded_tests();
+        run_eviction_tests();
+        run_read_index_tests();
+        run_lazyfree_tests();
+        run_large_value_tests();
         
         std::cout << "\n=== Test Summary ===" << std::endl;
         std::cout << "Tests Passed: " << tests_passed << std::endl;
@@ -0,0 +1,72 @@
+#include "resp.h"
+
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+
+static RequestStatus parse_length(const std::string& buffer, size_t& cursor, char prefix, long long limit, long long& value) {
+    if (buffer[cursor] != prefix) return REQUEST_ERROR;
+    
+    size_t end = buffer.find("\r\n", cursor);
+    if (end == std::string::npos) {
+        return buffer.size() - cursor > 32 ? REQUEST_ERROR : REQUEST_INCOMPLETE;
+    }
+    if (end == cursor + 1) return REQUEST_ERROR;
+    
+    value = 0;
+    for (size_t i = cursor + 1; i < end; ++i) {
+        if (!isdigit(static_cast<unsigned char>(buffer[i]))) return REQUEST_ERROR;
+        value = value * 10 + (buffer[i] - '0');
+        if (value > limit) return REQUEST_ERROR;
+    }
+    cursor = end + 2;
+    return REQUEST_READY;
+}
+
+RequestStatus parse_request(const std::string& buffer, size_t& pos, std::vector<std::string>& tokens) {
+    tokens.clear();
+    if (pos >= buffer.size()) return REQUEST_INCOMPLETE;
+    
+    if (buffer[pos] != '*') {
+        size_t end = buffer.find("\r\n", pos);
+        if (end == std::string::npos) {
+            return buffer.size() - pos > kMaxInlineLength ? REQUEST_ERROR : REQUEST_INCOMPLETE;
+        }
+        tokens = parse_command(buffer.substr(pos, end - pos));
+        pos = end + 2;
+        return REQUEST_READY;
+    }
+    
+    size_t cursor = pos;
+    long long count;
+    RequestStatus status = parse_length(buffer, cursor, '*', kMaxMultibulkLength, count);
+    if (status != REQUEST_READY) return status;
+    
+    // count is client-supplied; reserve a bounded amount and let the vector
+    // grow as bulk strings actually arrive.
+    tokens.reserve(std::min<long long>(count, 1024));
+    for (long long i = 0; i < count; ++i) {
+        if (cursor >= buffer.size()) return REQUEST_INCOMPLETE;
+        long long length;
+        status = parse_length(buffer, cursor, '$', kMaxBulkLength, length);
+        if (status != REQUEST_READY) return status;
+        if (buffer.size() - cursor < static_cast<size_t>(length) + 2) return REQUEST_INCOMPLETE;
+        if (buffer[cursor + length] != '\r' || buffer[cursor + length + 1] != '\n') return REQUEST_ERROR;
+        
+        tokens.emplace_back(buffer, cursor, length);
+        cursor += length + 2;
+    }
+    pos = cursor;
+    return REQUEST_READY;
+}
+
+std::vector<std::string> parse_command(const std::string& input) {
+    std::vector<std::string> tokens;
+    std::istringstream iss(input);
+    std::string token;
+    
+    while (iss >> token) {
+        tokens.push_back(token);
+    }
+    return tokens;
+}
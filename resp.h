@@ -0,0 +1,132 @@
+#ifndef REDIS_CLONE_RESP_H
+#define REDIS_CLONE_RESP_H
+
+// RESP codec: reply encoders and the request parser shared by the server,
+// the embedding API and the microbenchmarks.
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// Reply builders append straight into an output buffer, so a handler can
+// stream a collection without building its elements up first. Each one
+// formats its header on the stack and appends it in one piece.
+inline char* format_decimal(char* end, unsigned long long value) {
+    static constexpr char kDigitPairs[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+    
+    while (value >= 100) {
+        const char* pair = kDigitPairs + (value % 100) * 2;
+        value /= 100;
+        *--end = pair[1];
+        *--end = pair[0];
+    }
+    if (value >= 10) {
+        const char* pair = kDigitPairs + value * 2;
+        *--end = pair[1];
+        *--end = pair[0];
+    } else {
+        *--end = static_cast<char>('0' + value);
+    }
+    return end;
+}
+
+// Appends prefix, the decimal value and CRLF, e.g. ":42\r\n" or "$5\r\n".
+inline void append_prefixed_decimal(std::string& out, char prefix, long long value) {
+    char buffer[24];
+    char* end = buffer + sizeof(buffer);
+    *--end = '\n';
+    *--end = '\r';
+    unsigned long long magnitude = value < 0 ? 0ULL - static_cast<unsigned long long>(value) : value;
+    char* p = format_decimal(end, magnitude);
+    if (value < 0) *--p = '-';
+    *--p = prefix;
+    out.append(p, buffer + sizeof(buffer) - p);
+}
+
+inline void append_bulk_string(std::string& out, const char* data, size_t length) {
+    out.reserve(out.size() + length + 24);
+    append_prefixed_decimal(out, '$', static_cast<long long>(length));
+    out.append(data, length);
+    out.append("\r\n", 2);
+}
+
+inline void append_bulk_string(std::string& out, const std::string& str) {
+    append_bulk_string(out, str.data(), str.size());
+}
+
+inline void append_null_bulk(std::string& out) {
+    out.append("$-1\r\n", 5);
+}
+
+inline void append_integer(std::string& out, long long value) {
+    append_prefixed_decimal(out, ':', value);
+}
+
+inline void append_array_header(std::string& out, size_t count) {
+    append_prefixed_decimal(out, '*', static_cast<long long>(count));
+}
+
+inline void append_simple_string(std::string& out, const char* str) {
+    out += '+';
+    out += str;
+    out.append("\r\n", 2);
+}
+
+inline void append_error(std::string& out, const std::string& error) {
+    out += '-';
+    out += error;
+    out.append("\r\n", 2);
+}
+
+// Value-returning forms for replies off the hot path (INFO, SLOWLOG, ...).
+inline std::string encode_bulk_string(const std::string& str) {
+    std::string out;
+    append_bulk_string(out, str);
+    return out;
+}
+
+inline std::string encode_array(const std::vector<std::string>& arr) {
+    std::string out;
+    append_array_header(out, arr.size());
+    for (const auto& item : arr) {
+        append_bulk_string(out, item);
+    }
+    return out;
+}
+
+inline std::string encode_integer(long long value) {
+    std::string out;
+    append_integer(out, value);
+    return out;
+}
+
+inline std::string encode_simple_string(const std::string& str) {
+    return "+" + str + "\r\n";
+}
+
+inline std::string encode_error(const std::string& error) {
+    return "-" + error + "\r\n";
+}
+
+inline std::string encode_array_header(size_t count) {
+    std::string out;
+    append_array_header(out, count);
+    return out;
+}
+
+enum RequestStatus { REQUEST_INCOMPLETE, REQUEST_READY, REQUEST_ERROR };
+
+constexpr size_t kMaxInlineLength = 64 * 1024;
+constexpr long long kMaxMultibulkLength = 1024 * 1024;
+constexpr long long kMaxBulkLength = 512LL * 1024 * 1024;
+
+// Parses one request starting at pos: either a RESP multibulk array of bulk
+// strings or an inline command line. On success pos moves past the request.
+RequestStatus parse_request(const std::string& buffer, size_t& pos, std::vector<std::string>& tokens);
+
+// Splits an inline command line on whitespace.
+std::vector<std::string> parse_command(const std::string& input);
+
+#endif